@@ -0,0 +1,138 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+// Homogeneous calibration of the first N linear axes: an (N+1)x(N+1) row-major matrix maps
+// [p, 1] to [p', w'] and the stage position is p' / w'. The dimension is a template parameter,
+// so the matrix is a fixed-size array and the per-point loops unroll at compile time.
+// Coordinates past the first N pass through unchanged; if fewer than N are given (but at
+// least 2), the missing linear coordinates are taken as 0 (e.g. X/Y on the Z = 0 plane).
+// CalibrationManager keeps its specialised 2D path (classified matrices, SIMD batches);
+// this template provides Calibration<3> (XYZ, 4x4) and Calibration<4> (5x5).
+template <std::size_t N>
+class Calibration {
+    static_assert(N >= 2, "Calibration needs at least two linear axes");
+public:
+    static constexpr std::size_t kDims = N;
+    static constexpr std::size_t kSize = N + 1;
+    using Matrix = std::array<double, kSize * kSize>;
+private:
+    Matrix matrix;
+    Matrix inverse;   // identity when the matrix is singular
+    bool affine;      // bottom row is (0, ..., 0, 1): no perspective divide
+    bool inverseAffine;
+    bool invertible;
+
+    static Matrix identity() {
+        Matrix m{};
+        for (std::size_t i = 0; i < kSize; ++i) m[i * kSize + i] = 1.0;
+        return m;
+    }
+
+    static bool isAffineMatrix(const Matrix& m) {
+        for (std::size_t c = 0; c < N; ++c) {
+            if (m[N * kSize + c] != 0.0) return false;
+        }
+        return m[N * kSize + N] == 1.0;
+    }
+
+    // Gauss-Jordan elimination with partial pivoting; returns false for a (numerically) singular matrix
+    static bool invertMatrix(const Matrix& m, Matrix& inv) {
+        Matrix a = m;
+        inv = identity();
+        double scale = 0.0;
+        for (double v : m) scale = std::max(scale, std::fabs(v));
+        if (!(scale > 0.0) || !std::isfinite(scale)) return false;
+        for (std::size_t col = 0; col < kSize; ++col) {
+            std::size_t pivot = col;
+            for (std::size_t r = col + 1; r < kSize; ++r) {
+                if (std::fabs(a[r * kSize + col]) > std::fabs(a[pivot * kSize + col])) pivot = r;
+            }
+            if (std::fabs(a[pivot * kSize + col]) <= 1e-12 * scale) return false;
+            if (pivot != col) {
+                for (std::size_t c = 0; c < kSize; ++c) {
+                    std::swap(a[pivot * kSize + c], a[col * kSize + c]);
+                    std::swap(inv[pivot * kSize + c], inv[col * kSize + c]);
+                }
+            }
+            double invPivot = 1.0 / a[col * kSize + col];
+            for (std::size_t c = 0; c < kSize; ++c) {
+                a[col * kSize + c] *= invPivot;
+                inv[col * kSize + c] *= invPivot;
+            }
+            for (std::size_t r = 0; r < kSize; ++r) {
+                if (r == col) continue;
+                double f = a[r * kSize + col];
+                if (f == 0.0) continue;
+                for (std::size_t c = 0; c < kSize; ++c) {
+                    a[r * kSize + c] -= f * a[col * kSize + c];
+                    inv[r * kSize + c] -= f * inv[col * kSize + c];
+                }
+            }
+        }
+        // The inverse of an affine matrix is affine; pin its bottom row against rounding
+        if (isAffineMatrix(m)) {
+            for (std::size_t c = 0; c < N; ++c) inv[N * kSize + c] = 0.0;
+            inv[N * kSize + N] = 1.0;
+        }
+        return true;
+    }
+
+    static void transform(const Matrix& m, bool isAffine, const double* in, double* out, std::size_t count) {
+        if (count < 2) {
+            if (out != in && count == 1) out[0] = in[0];
+            return;
+        }
+        // Read everything before writing so out may alias in
+        double p[N];
+        for (std::size_t i = 0; i < N; ++i) p[i] = (i < count) ? in[i] : 0.0;
+        double w = 1.0;
+        if (!isAffine) {
+            double wPrime = m[N * kSize + N];
+            for (std::size_t c = 0; c < N; ++c) wPrime += m[N * kSize + c] * p[c];
+            w = (wPrime != 0.0) ? wPrime : 1.0;
+        }
+        double q[N];
+        for (std::size_t r = 0; r < N; ++r) {
+            double v = m[r * kSize + N];
+            for (std::size_t c = 0; c < N; ++c) v += m[r * kSize + c] * p[c];
+            q[r] = v / w;
+        }
+        const std::size_t linear = std::min(count, N);
+        for (std::size_t i = 0; i < linear; ++i) out[i] = q[i];
+        if (out != in) {
+            for (std::size_t i = N; i < count; ++i) out[i] = in[i];
+        }
+    }
+public:
+    Calibration() : matrix(identity()), inverse(identity()), affine(true), inverseAffine(true), invertible(true) {}
+    explicit Calibration(const Matrix& m) : Calibration() { setMatrix(m); }
+
+    // Install the matrix; its inverse is computed here, not per point
+    void setMatrix(const Matrix& m) {
+        matrix = m;
+        affine = isAffineMatrix(m);
+        invertible = invertMatrix(m, inverse);
+        if (!invertible) inverse = identity();
+        inverseAffine = isAffineMatrix(inverse);
+    }
+    const Matrix& getMatrix() const { return matrix; }
+    const Matrix& getInverse() const { return inverse; }
+    bool isAffine() const { return affine; }
+    bool isInvertible() const { return invertible; }
+
+    // World -> stage for one point of count coordinates (out may equal in)
+    void apply(const double* in, double* out, std::size_t count) const {
+        transform(matrix, affine, in, out, count);
+    }
+    // Stage -> world; coordinates pass through unchanged if the matrix is singular
+    void applyInverse(const double* in, double* out, std::size_t count) const {
+        transform(inverse, inverseAffine, in, out, count);
+    }
+};
+
+#endif // CALIBRATION_H
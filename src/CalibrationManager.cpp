@@ -1,33 +1,602 @@
 #include "CalibrationManager.h"
+#include <algorithm>
 #include <cmath>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <variant>
 
-CalibrationManager::CalibrationManager() {
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+using MatrixClass = CalibrationManager::MatrixClass;
+
+const int kErrorMapInverseIterations = 4;
+
+// Scalar projective kernel shared by the single-point and batch paths. The divide is branch-free:
+// a zero w' selects 1.0 so the point passes through undivided, as before.
+inline void transformPoint(const double* m, double x, double y, double& xOut, double& yOut) {
+    double x_prime = x * m[0] + y * m[1] + m[2];
+    double y_prime = x * m[3] + y * m[4] + m[5];
+    double w_prime = x * m[6] + y * m[7] + m[8];
+    double w = (w_prime != 0.0) ? w_prime : 1.0;
+    xOut = x_prime / w;
+    yOut = y_prime / w;
+}
+
+// Affine kernel (bottom row 0, 0, 1): no divide
+inline void transformPointAffine(const double* m, double x, double y, double& xOut, double& yOut) {
+    double x_prime = x * m[0] + y * m[1] + m[2];
+    double y_prime = x * m[3] + y * m[4] + m[5];
+    xOut = x_prime;
+    yOut = y_prime;
+}
+
+MatrixClass classify(const std::array<double, 9>& m) {
+    if (m[6] != 0.0 || m[7] != 0.0 || m[8] != 1.0) return MatrixClass::Projective;
+    if (m[0] != 1.0 || m[1] != 0.0 || m[3] != 0.0 || m[4] != 1.0) return MatrixClass::Affine;
+    if (m[2] != 0.0 || m[5] != 0.0) return MatrixClass::Translation;
+    return MatrixClass::Identity;
+}
+
+// Inverse via the adjugate; returns false for a (numerically) singular matrix
+bool invert(const std::array<double, 9>& m, std::array<double, 9>& inv) {
+    double c0 = m[4] * m[8] - m[5] * m[7];
+    double c1 = m[5] * m[6] - m[3] * m[8];
+    double c2 = m[3] * m[7] - m[4] * m[6];
+    double det = m[0] * c0 + m[1] * c1 + m[2] * c2;
+    double scale = 0.0;
+    for (double v : m) scale = std::max(scale, std::fabs(v));
+    if (det == 0.0 || !std::isfinite(det) || std::fabs(det) <= 1e-12 * scale * scale * scale) return false;
+    double invDet = 1.0 / det;
+    inv = {c0 * invDet, (m[2] * m[7] - m[1] * m[8]) * invDet, (m[1] * m[5] - m[2] * m[4]) * invDet,
+           c1 * invDet, (m[0] * m[8] - m[2] * m[6]) * invDet, (m[2] * m[3] - m[0] * m[5]) * invDet,
+           c2 * invDet, (m[1] * m[6] - m[0] * m[7]) * invDet, (m[0] * m[4] - m[1] * m[3]) * invDet};
+    // The inverse of an affine matrix is affine; pin its bottom row against rounding
+    if (m[6] == 0.0 && m[7] == 0.0 && m[8] == 1.0) {
+        inv[6] = 0.0;
+        inv[7] = 0.0;
+        inv[8] = 1.0;
+    }
+    return true;
+}
+
+// Single point dispatch on the matrix class (count >= 2 coordinates, extra ones untouched)
+inline void transformDispatch(const double* m, MatrixClass cls, double x, double y, double& xOut, double& yOut) {
+    switch (cls) {
+    case MatrixClass::Identity:
+        xOut = x;
+        yOut = y;
+        break;
+    case MatrixClass::Translation:
+        xOut = x + m[2];
+        yOut = y + m[5];
+        break;
+    case MatrixClass::Affine:
+        transformPointAffine(m, x, y, xOut, yOut);
+        break;
+    case MatrixClass::Projective:
+        transformPoint(m, x, y, xOut, yOut);
+        break;
+    }
+}
+
+// SIMD operations for the batch kernels; the widest instruction set enabled at build time is used
+#if defined(__AVX__)
+struct SimdOps {
+    using V = __m256d;
+    static constexpr std::size_t width = 4;
+    static V set1(double v) { return _mm256_set1_pd(v); }
+    static V load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm256_div_pd(a, b); }
+    static V unpackLo(V a, V b) { return _mm256_unpacklo_pd(a, b); }
+    static V unpackHi(V a, V b) { return _mm256_unpackhi_pd(a, b); }
+    // w where w != 0 (or NaN), else 1.0
+    static V safeDivisor(V w, V one) {
+        return _mm256_blendv_pd(one, w, _mm256_cmp_pd(w, _mm256_setzero_pd(), _CMP_NEQ_UQ));
+    }
+};
+#define CALIBRATION_HAVE_SIMD 1
+#elif defined(__SSE2__)
+struct SimdOps {
+    using V = __m128d;
+    static constexpr std::size_t width = 2;
+    static V set1(double v) { return _mm_set1_pd(v); }
+    static V load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+    static V add(V a, V b) { return _mm_add_pd(a, b); }
+    static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm_div_pd(a, b); }
+    static V unpackLo(V a, V b) { return _mm_unpacklo_pd(a, b); }
+    static V unpackHi(V a, V b) { return _mm_unpackhi_pd(a, b); }
+    static V safeDivisor(V w, V one) {
+        V mask = _mm_cmpneq_pd(w, _mm_setzero_pd());
+        return _mm_or_pd(_mm_and_pd(mask, w), _mm_andnot_pd(mask, one));
+    }
+};
+#define CALIBRATION_HAVE_SIMD 1
+#endif
+
+#ifdef CALIBRATION_HAVE_SIMD
+// Broadcast matrix coefficients and the affine or projective transform on one vector of points
+template <bool Projective>
+struct SimdTransform {
+    SimdOps::V m[9];
+    SimdOps::V one;
+    explicit SimdTransform(const double* matrix) : one(SimdOps::set1(1.0)) {
+        for (int i = 0; i < 9; ++i) m[i] = SimdOps::set1(matrix[i]);
+    }
+    void apply(SimdOps::V x, SimdOps::V y, SimdOps::V& xOut, SimdOps::V& yOut) const {
+        using O = SimdOps;
+        O::V xp = O::add(O::add(O::mul(x, m[0]), O::mul(y, m[1])), m[2]);
+        O::V yp = O::add(O::add(O::mul(x, m[3]), O::mul(y, m[4])), m[5]);
+        if (Projective) {
+            O::V w  = O::add(O::add(O::mul(x, m[6]), O::mul(y, m[7])), m[8]);
+            O::V ws = O::safeDivisor(w, one);
+            xOut = O::div(xp, ws);
+            yOut = O::div(yp, ws);
+        } else {
+            xOut = xp;
+            yOut = yp;
+        }
+    }
+};
+#endif
+
+// SoA batch kernel for one matrix class (Projective selects the divide)
+template <bool Projective>
+void batchSoA(const double* m, const double* xIn, const double* yIn,
+              double* xOut, double* yOut, std::size_t count) {
+    std::size_t i = 0;
+#ifdef CALIBRATION_HAVE_SIMD
+    SimdTransform<Projective> t(m);
+    for (; i + SimdOps::width <= count; i += SimdOps::width) {
+        SimdOps::V xr, yr;
+        t.apply(SimdOps::load(xIn + i), SimdOps::load(yIn + i), xr, yr);
+        SimdOps::store(xOut + i, xr);
+        SimdOps::store(yOut + i, yr);
+    }
+#endif
+    for (; i < count; ++i) {
+        if (Projective) {
+            transformPoint(m, xIn[i], yIn[i], xOut[i], yOut[i]);
+        } else {
+            transformPointAffine(m, xIn[i], yIn[i], xOut[i], yOut[i]);
+        }
+    }
+}
+
+// AoS batch kernel for one matrix class
+template <bool Projective>
+void batchAoS(const double* m, const double* pointsIn, double* pointsOut,
+              std::size_t count, std::size_t stride) {
+    std::size_t i = 0;
+#ifdef CALIBRATION_HAVE_SIMD
+    if (stride == 2) {
+        // Interleaved (x, y) pairs: unpack into X/Y lanes, transform, re-interleave.
+        // Lane order after unpacking is permuted, but the transform is element-wise.
+        SimdTransform<Projective> t(m);
+        for (; i + SimdOps::width <= count; i += SimdOps::width) {
+            const double* src = pointsIn + 2 * i;
+            SimdOps::V a = SimdOps::load(src);
+            SimdOps::V b = SimdOps::load(src + SimdOps::width);
+            SimdOps::V xr, yr;
+            t.apply(SimdOps::unpackLo(a, b), SimdOps::unpackHi(a, b), xr, yr);
+            double* dst = pointsOut + 2 * i;
+            SimdOps::store(dst, SimdOps::unpackLo(xr, yr));
+            SimdOps::store(dst + SimdOps::width, SimdOps::unpackHi(xr, yr));
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        const double* src = pointsIn + i * stride;
+        double* dst = pointsOut + i * stride;
+        if (Projective) {
+            transformPoint(m, src[0], src[1], dst[0], dst[1]);
+        } else {
+            transformPointAffine(m, src[0], src[1], dst[0], dst[1]);
+        }
+        if (dst != src) {
+            for (std::size_t k = 2; k < stride; ++k) dst[k] = src[k];
+        }
+    }
+}
+
+// Point-wise copy used by the identity class (skipped entirely when in place)
+void copySoA(const double* xIn, const double* yIn, double* xOut, double* yOut, std::size_t count) {
+    if (xOut != xIn) std::copy(xIn, xIn + count, xOut);
+    if (yOut != yIn) std::copy(yIn, yIn + count, yOut);
+}
+
+void applySingle(const double* m, MatrixClass cls, const double* coordinates, double* result, std::size_t count) {
+    // Any additional coordinates (e.g., Z or Theta) pass through unchanged
+    if (result != coordinates) {
+        for (std::size_t i = 0; i < count; ++i) result[i] = coordinates[i];
+    }
+    if (count >= 2 && cls != MatrixClass::Identity) {
+        // Apply 2D homogeneous transform: [x', y', w'] = [x, y, 1] * calibMatrix
+        transformDispatch(m, cls, coordinates[0], coordinates[1], result[0], result[1]);
+    }
+}
+
+void applyBatchSoA(const double* m, MatrixClass cls, const double* xIn, const double* yIn,
+                   double* xOut, double* yOut, std::size_t count) {
+    switch (cls) {
+    case MatrixClass::Identity:
+        copySoA(xIn, yIn, xOut, yOut, count);
+        break;
+    case MatrixClass::Translation:
+    case MatrixClass::Affine:
+        batchSoA<false>(m, xIn, yIn, xOut, yOut, count);
+        break;
+    case MatrixClass::Projective:
+        batchSoA<true>(m, xIn, yIn, xOut, yOut, count);
+        break;
+    }
+}
+
+// Solve p + e(p) = s; corrections are small and smooth, so a few iterations converge
+void removeErrorMap(const ErrorMap& errorMap, double sx, double sy, double& px, double& py) {
+    px = sx;
+    py = sy;
+    for (int iter = 0; iter < kErrorMapInverseIterations; ++iter) {
+        double dx, dy;
+        errorMap.lookup(px, py, dx, dy);
+        px = sx - dx;
+        py = sy - dy;
+    }
+}
+
+// Calls f with the 3D / 4D calibration held by the variant; returns false for a 2D calibration
+template <class Spatial, class F>
+bool visitSpatial(const Spatial& spatial, F&& f) {
+    return std::visit([&f](const auto& c) {
+        if constexpr (std::is_same<std::decay_t<decltype(c)>, std::monostate>::value) {
+            return false;
+        } else {
+            f(c);
+            return true;
+        }
+    }, spatial);
+}
+
+template <class Spatial>
+bool applySpatial(const Spatial& spatial, bool inverse, const double* in, double* out, std::size_t count) {
+    return visitSpatial(spatial, [&](const auto& c) {
+        if (inverse) {
+            c.applyInverse(in, out, count);
+        } else {
+            c.apply(in, out, count);
+        }
+    });
+}
+
+// Axes from `first` on that have a mapping: stage = scale * world + offset (in place)
+void applyAxisMappings(const std::vector<CalibrationManager::AxisMapping>& maps, std::size_t first,
+                       double* values, std::size_t count) {
+    std::size_t end = std::min(count, maps.size());
+    for (std::size_t i = first; i < end; ++i) {
+        values[i] = values[i] * maps[i].scale + maps[i].offset;
+    }
+}
+
+void removeAxisMappings(const std::vector<CalibrationManager::AxisMapping>& maps, std::size_t first,
+                        double* values, std::size_t count) {
+    std::size_t end = std::min(count, maps.size());
+    for (std::size_t i = first; i < end; ++i) {
+        values[i] = (values[i] - maps[i].offset) / maps[i].scale;
+    }
+}
+
+const std::array<double, 9> kIdentity = {1.0, 0.0, 0.0,
+                                         0.0, 1.0, 0.0,
+                                         0.0, 0.0, 1.0};
+
+} // namespace
+
+CalibrationManager::ReadGuard::ReadGuard(const CalibrationManager& owner) : slot(nullptr), snap(nullptr) {
+    // Claim a free hazard slot, starting at a per-thread position so threads rarely collide
+    const int n = kMaxConcurrentReaders;
+    std::size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+    for (int i = 0; slot == nullptr; ++i) {
+        HazardSlot& candidate = owner.hazards[(start + static_cast<std::size_t>(i)) % n];
+        if (!candidate.claimed.load(std::memory_order_relaxed) &&
+            !candidate.claimed.exchange(true, std::memory_order_acquire)) {
+            slot = &candidate;
+        } else if (i > 0 && i % n == 0) {
+            std::this_thread::yield();  // all slots busy: wait for a reader to finish
+        }
+    }
+    // Publish the hazard, then confirm the snapshot is still current; a writer that retired it
+    // in between either sees our hazard (and keeps it alive) or we see its replacement
+    const Snapshot* s = owner.current.load(std::memory_order_acquire);
+    for (;;) {
+        slot->pointer.store(s, std::memory_order_seq_cst);
+        const Snapshot* again = owner.current.load(std::memory_order_seq_cst);
+        if (again == s) break;
+        s = again;
+    }
+    snap = s;
+}
+
+CalibrationManager::ReadGuard::~ReadGuard() {
+    slot->pointer.store(nullptr, std::memory_order_release);
+    slot->claimed.store(false, std::memory_order_release);
+}
+
+CalibrationManager::CalibrationManager() : current(nullptr), lastVersion(0) {
     // Initialize to identity matrix (no transformation)
-    calibMatrix = {1.0, 0.0, 0.0,
-                   0.0, 1.0, 0.0,
-                   0.0, 0.0, 1.0};
+    std::lock_guard<std::mutex> lock(writerMtx);
+    Snapshot initial;
+    installMatrix(initial, kIdentity);
+    publishLocked(std::move(initial));
+}
+
+CalibrationManager::~CalibrationManager() {
+    delete current.load(std::memory_order_relaxed);
+    for (const Snapshot* s : retired) delete s;
+}
+
+CalibrationManager::Snapshot CalibrationManager::draftLocked() const {
+    return *current.load(std::memory_order_relaxed);
+}
+
+void CalibrationManager::installMatrix(Snapshot& s, const std::array<double, 9>& matrix) {
+    s.calibMatrix = matrix;
+    s.matrixClass = classify(matrix);
+    s.invertible = invert(matrix, s.inverseMatrix);
+    if (!s.invertible) s.inverseMatrix = kIdentity;
+    s.inverseClass = classify(s.inverseMatrix);
+    s.spatial = std::monostate();
+    s.linearAxes = 2;
+}
+
+void CalibrationManager::publishLocked(Snapshot next) {
+    next.version = ++lastVersion;
+    const Snapshot* old = current.exchange(new Snapshot(std::move(next)), std::memory_order_seq_cst);
+    if (old == nullptr) return;
+    retired.push_back(old);
+    // Free every retired snapshot no reader has published as its hazard
+    auto inUse = [this](const Snapshot* s) {
+        for (const HazardSlot& h : hazards) {
+            if (h.pointer.load(std::memory_order_seq_cst) == s) return true;
+        }
+        return false;
+    };
+    auto keep = std::partition(retired.begin(), retired.end(), inUse);
+    for (auto it = keep; it != retired.end(); ++it) delete *it;
+    retired.erase(keep, retired.end());
 }
 
 void CalibrationManager::setCalibrationMatrix(const std::array<double, 9>& matrix) {
-    calibMatrix = matrix;
+    std::lock_guard<std::mutex> lock(writerMtx);
+    Snapshot next = draftLocked();
+    installMatrix(next, matrix);
+    publishLocked(std::move(next));
+}
+
+void CalibrationManager::setCalibration(const std::array<double, 9>& matrix, const ErrorMap& map) {
+    std::lock_guard<std::mutex> lock(writerMtx);
+    Snapshot next = draftLocked();
+    installMatrix(next, matrix);
+    next.errorMap = map;
+    publishLocked(std::move(next));
+}
+
+void CalibrationManager::setCalibration(const Calibration<3>& calibration) {
+    std::lock_guard<std::mutex> lock(writerMtx);
+    Snapshot next = draftLocked();
+    installMatrix(next, kIdentity);
+    next.spatial = calibration;
+    next.linearAxes = 3;
+    publishLocked(std::move(next));
+}
+
+void CalibrationManager::setCalibration(const Calibration<4>& calibration) {
+    std::lock_guard<std::mutex> lock(writerMtx);
+    Snapshot next = draftLocked();
+    installMatrix(next, kIdentity);
+    next.spatial = calibration;
+    next.linearAxes = 4;
+    publishLocked(std::move(next));
+}
+
+std::size_t CalibrationManager::getLinearAxes() const {
+    ReadGuard snap(*this);
+    return snap->linearAxes;
+}
+
+bool CalibrationManager::setAxisMapping(std::size_t axis, double scale, double offset) {
+    if (scale == 0.0 || !std::isfinite(scale) || !std::isfinite(offset)) return false;
+    std::lock_guard<std::mutex> lock(writerMtx);
+    Snapshot next = draftLocked();
+    if (next.axisMappings.size() <= axis) next.axisMappings.resize(axis + 1);
+    next.axisMappings[axis] = AxisMapping{scale, offset};
+    publishLocked(std::move(next));
+    return true;
+}
+
+void CalibrationManager::clearAxisMappings() {
+    std::lock_guard<std::mutex> lock(writerMtx);
+    Snapshot next = draftLocked();
+    next.axisMappings.clear();
+    publishLocked(std::move(next));
+}
+
+FitResult CalibrationManager::fitCalibration(const std::vector<PointPair>& pairs, const FitOptions& options) {
+    FitResult result = CalibrationSolver::fit(pairs, options);
+    if (result.success) {
+        setCalibrationMatrix(result.matrix);
+    }
+    return result;
+}
+
+CalibrationManager::MatrixClass CalibrationManager::getMatrixClass() const {
+    ReadGuard snap(*this);
+    MatrixClass cls = snap->matrixClass;
+    visitSpatial(snap->spatial, [&cls](const auto& c) {
+        cls = c.isAffine() ? MatrixClass::Affine : MatrixClass::Projective;
+    });
+    return cls;
+}
+
+bool CalibrationManager::isInvertible() const {
+    ReadGuard snap(*this);
+    bool invertible = snap->invertible;
+    visitSpatial(snap->spatial, [&invertible](const auto& c) { invertible = c.isInvertible(); });
+    return invertible;
+}
+
+std::uint64_t CalibrationManager::getVersion() const {
+    ReadGuard snap(*this);
+    return snap->version;
+}
+
+void CalibrationManager::setErrorMap(const ErrorMap& map) {
+    std::lock_guard<std::mutex> lock(writerMtx);
+    Snapshot next = draftLocked();
+    next.errorMap = map;
+    publishLocked(std::move(next));
+}
+
+bool CalibrationManager::loadErrorMap(const std::string& path) {
+    ErrorMap loaded;
+    if (!loaded.loadFromFile(path)) return false;
+    setErrorMap(loaded);
+    return true;
+}
+
+void CalibrationManager::clearErrorMap() {
+    setErrorMap(ErrorMap());
+}
+
+ErrorMap CalibrationManager::getErrorMap() const {
+    ReadGuard snap(*this);
+    return snap->errorMap;
 }
 
 std::vector<double> CalibrationManager::applyCalibration(const std::vector<double>& coordinates) const {
-    std::vector<double> result = coordinates;
-    if (coordinates.size() >= 2) {
-        // Apply 2D homogeneous transform: [x', y', w'] = [x, y, 1] * calibMatrix
-        double x = coordinates[0];
-        double y = coordinates[1];
-        double x_prime = x * calibMatrix[0] + y * calibMatrix[1] + 1.0 * calibMatrix[2];
-        double y_prime = x * calibMatrix[3] + y * calibMatrix[4] + 1.0 * calibMatrix[5];
-        double w_prime = x * calibMatrix[6] + y * calibMatrix[7] + 1.0 * calibMatrix[8];
-        if (w_prime != 0.0) {
-            x_prime /= w_prime;
-            y_prime /= w_prime;
-        }
-        result[0] = x_prime;
-        result[1] = y_prime;
-    }
-    // Any additional coordinates (e.g., Z or Theta) remain unchanged in result
+    std::vector<double> result(coordinates.size());
+    applyCalibration(coordinates.data(), result.data(), coordinates.size());
+    return result;
+}
+
+void CalibrationManager::applyCalibration(const double* coordinates, double* result, std::size_t count,
+                                          std::uint64_t* versionUsed) const {
+    ReadGuard snap(*this);
+    if (!applySpatial(snap->spatial, false, coordinates, result, count)) {
+        applySingle(snap->calibMatrix.data(), snap->matrixClass, coordinates, result, count);
+    }
+    if (count >= 2 && !snap->errorMap.isEmpty()) {
+        double dx, dy;
+        snap->errorMap.lookup(result[0], result[1], dx, dy);
+        result[0] += dx;
+        result[1] += dy;
+    }
+    applyAxisMappings(snap->axisMappings, snap->linearAxes, result, count);
+    if (versionUsed) *versionUsed = snap->version;
+}
+
+void CalibrationManager::applyCalibrationBatch(const double* xIn, const double* yIn,
+                                               double* xOut, double* yOut, std::size_t count) const {
+    ReadGuard snap(*this);
+    if (snap->linearAxes == 2) {
+        applyBatchSoA(snap->calibMatrix.data(), snap->matrixClass, xIn, yIn, xOut, yOut, count);
+    } else {
+        for (std::size_t i = 0; i < count; ++i) {
+            double p[2] = {xIn[i], yIn[i]};
+            applySpatial(snap->spatial, false, p, p, 2);
+            xOut[i] = p[0];
+            yOut[i] = p[1];
+        }
+    }
+    snap->errorMap.correctBatch(xOut, yOut, count);
+}
+
+void CalibrationManager::applyCalibrationBatch(const double* pointsIn, double* pointsOut,
+                                               std::size_t count, std::size_t stride) const {
+    if (stride < 2) return;
+    ReadGuard snap(*this);
+    const double* m = snap->calibMatrix.data();
+    if (snap->linearAxes != 2) {
+        for (std::size_t i = 0; i < count; ++i) {
+            applySpatial(snap->spatial, false, pointsIn + i * stride, pointsOut + i * stride, stride);
+        }
+    } else {
+        switch (snap->matrixClass) {
+        case MatrixClass::Identity:
+            if (pointsOut != pointsIn) std::copy(pointsIn, pointsIn + count * stride, pointsOut);
+            break;
+        case MatrixClass::Translation:
+        case MatrixClass::Affine:
+            batchAoS<false>(m, pointsIn, pointsOut, count, stride);
+            break;
+        case MatrixClass::Projective:
+            batchAoS<true>(m, pointsIn, pointsOut, count, stride);
+            break;
+        }
+    }
+    const ErrorMap& errorMap = snap->errorMap;
+    if (!errorMap.isEmpty()) {
+        for (std::size_t i = 0; i < count; ++i) {
+            double* p = pointsOut + i * stride;
+            double dx, dy;
+            errorMap.lookup(p[0], p[1], dx, dy);
+            p[0] += dx;
+            p[1] += dy;
+        }
+    }
+    if (snap->axisMappings.size() > snap->linearAxes) {
+        for (std::size_t i = 0; i < count; ++i) {
+            applyAxisMappings(snap->axisMappings, snap->linearAxes, pointsOut + i * stride, stride);
+        }
+    }
+}
+
+std::vector<double> CalibrationManager::applyInverseCalibration(const std::vector<double>& coordinates) const {
+    std::vector<double> result(coordinates.size());
+    applyInverseCalibration(coordinates.data(), result.data(), coordinates.size());
     return result;
 }
+
+void CalibrationManager::applyInverseCalibration(const double* coordinates, double* result, std::size_t count) const {
+    ReadGuard snap(*this);
+    if (result != coordinates) {
+        for (std::size_t i = 0; i < count; ++i) result[i] = coordinates[i];
+    }
+    if (count >= 2 && !snap->errorMap.isEmpty()) {
+        removeErrorMap(snap->errorMap, result[0], result[1], result[0], result[1]);
+    }
+    if (!applySpatial(snap->spatial, true, result, result, count)) {
+        applySingle(snap->inverseMatrix.data(), snap->inverseClass, result, result, count);
+    }
+    removeAxisMappings(snap->axisMappings, snap->linearAxes, result, count);
+}
+
+void CalibrationManager::applyInverseCalibrationBatch(const double* xIn, const double* yIn,
+                                                      double* xOut, double* yOut, std::size_t count) const {
+    ReadGuard snap(*this);
+    const bool planar = snap->linearAxes == 2;
+    if (planar && snap->errorMap.isEmpty()) {
+        applyBatchSoA(snap->inverseMatrix.data(), snap->inverseClass, xIn, yIn, xOut, yOut, count);
+        return;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        double p[2] = {xIn[i], yIn[i]};
+        if (!snap->errorMap.isEmpty()) removeErrorMap(snap->errorMap, p[0], p[1], p[0], p[1]);
+        if (!planar) applySpatial(snap->spatial, true, p, p, 2);
+        xOut[i] = p[0];
+        yOut[i] = p[1];
+    }
+    if (planar) {
+        applyBatchSoA(snap->inverseMatrix.data(), snap->inverseClass, xOut, yOut, xOut, yOut, count);
+    }
+}
@@ -3,18 +3,151 @@
 
 #include <vector>
 #include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <variant>
+#include "Calibration.h"
+#include "ErrorMap.h"
+#include "CalibrationSolver.h"
 
-// Manages calibration transforms (e.g., coordinate alignment, scaling, offsets)
+// Manages calibration transforms (e.g., coordinate alignment, scaling, offsets).
+// Safe for concurrent use: any number of threads may apply calibration (lock-free, up to
+// kMaxConcurrentReaders at once) while another thread swaps in a new calibration.
 class CalibrationManager {
+public:
+    // Structural class of a calibration matrix, used to pick the cheapest transform kernel
+    enum class MatrixClass {
+        Identity,    // no-op
+        Translation, // x' = x + tx, y' = y + ty
+        Affine,      // bottom row is (0, 0, 1): no perspective divide
+        Projective   // general homography
+    };
+    // Per-axis policy for axes outside the matrix transform (e.g. a rotary axis):
+    // stage = scale * world + offset. The default is pass-through.
+    struct AxisMapping {
+        double scale = 1.0;
+        double offset = 0.0;
+    };
 private:
-    // 3x3 homogeneous transformation matrix for 2D (X, Y) coordinates
-    std::array<double, 9> calibMatrix;
+    // Optional 3D / 4D matrix replacing the 2D one (monostate = 2D calibration)
+    using SpatialCalibration = std::variant<std::monostate, Calibration<3>, Calibration<4>>;
+    // Immutable calibration state. Writers publish a new snapshot through an atomic pointer;
+    // readers never lock and never see a half-written matrix or error map.
+    struct Snapshot {
+        std::uint64_t version;
+        // 3x3 homogeneous transformation matrix for 2D (X, Y) coordinates
+        std::array<double, 9> calibMatrix;
+        MatrixClass matrixClass;
+        // Cached inverse (stage -> world); identity if calibMatrix is singular
+        std::array<double, 9> inverseMatrix;
+        MatrixClass inverseClass;
+        bool invertible;
+        // Nonlinear residual correction applied after the matrix transform (empty = none)
+        ErrorMap errorMap;
+        SpatialCalibration spatial;
+        std::size_t linearAxes;                // axes covered by the active matrix (2, 3 or 4)
+        std::vector<AxisMapping> axisMappings; // indexed by axis; used for axes >= linearAxes
+    };
+    // Hazard pointer slot: a reader publishes the snapshot it uses so writers defer freeing it
+    struct alignas(64) HazardSlot {
+        std::atomic<bool> claimed{false};
+        std::atomic<const Snapshot*> pointer{nullptr};
+    };
+    // RAII reader: claims a hazard slot and pins the current snapshot until destroyed
+    class ReadGuard {
+    private:
+        HazardSlot* slot;
+        const Snapshot* snap;
+    public:
+        explicit ReadGuard(const CalibrationManager& owner);
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        const Snapshot* operator->() const { return snap; }
+        const Snapshot& operator*() const { return *snap; }
+    };
+    static constexpr int kMaxConcurrentReaders = 64;
+
+    std::atomic<const Snapshot*> current;
+    mutable HazardSlot hazards[kMaxConcurrentReaders];
+    std::mutex writerMtx;                 // serializes writers (readers never take it)
+    std::vector<const Snapshot*> retired; // replaced snapshots awaiting reclamation (writerMtx)
+    std::uint64_t lastVersion;            // writerMtx
+
+    // Copy of the current snapshot for a writer to modify (caller holds writerMtx)
+    Snapshot draftLocked() const;
+    // Publish a modified draft as the next version and free unreferenced old snapshots.
+    // Caller holds writerMtx.
+    void publishLocked(Snapshot next);
+    // Install a 2D matrix in a draft: classify it, cache the inverse, drop any 3D / 4D matrix
+    static void installMatrix(Snapshot& s, const std::array<double, 9>& matrix);
 public:
     CalibrationManager();
-    // Set the calibration matrix (array of 9 values representing 3x3 matrix)
+    ~CalibrationManager();
+    CalibrationManager(const CalibrationManager&) = delete;
+    CalibrationManager& operator=(const CalibrationManager&) = delete;
+    // Set the calibration matrix (array of 9 values representing 3x3 matrix).
+    // The matrix is classified and its inverse precomputed here, not per point.
+    // Replaces any 3D / 4D calibration.
     void setCalibrationMatrix(const std::array<double, 9>& matrix);
-    // Apply calibration to input coordinates (only X and Y are transformed; additional coordinates pass through)
+    // Calibrate the first 3 (X, Y, Z) or 4 linear axes with a homogeneous matrix instead of the
+    // 2D one. The error map still corrects X / Y after the matrix.
+    void setCalibration(const Calibration<3>& calibration);
+    void setCalibration(const Calibration<4>& calibration);
+    // Number of leading axes transformed by the active matrix (2, 3 or 4)
+    std::size_t getLinearAxes() const;
+    // Map an axis outside the matrix transform as stage = scale * world + offset.
+    // Returns false for a zero or non-finite scale. Ignored while the matrix covers the axis.
+    bool setAxisMapping(std::size_t axis, double scale, double offset);
+    // Restore pass-through for every axis outside the matrix transform
+    void clearAxisMappings();
+    // Fit the calibration matrix from (world, stage) fiducial pairs and install it on success.
+    // The current matrix is left unchanged if the fit fails; the error map is not touched.
+    FitResult fitCalibration(const std::vector<PointPair>& pairs, const FitOptions& options = FitOptions());
+    // Classification of the current matrix (a 3D / 4D matrix is Affine or Projective)
+    MatrixClass getMatrixClass() const;
+    // Whether the current matrix has an inverse (stage -> world conversion is available)
+    bool isInvertible() const;
+    // Version of the published calibration (starts at 1, incremented by every change)
+    std::uint64_t getVersion() const;
+    // Atomically replace both the matrix and the error map in one new version
+    void setCalibration(const std::array<double, 9>& matrix, const ErrorMap& map);
+    // Install a grid error map applied after the matrix transform (copied)
+    void setErrorMap(const ErrorMap& map);
+    // Load the error map from its binary file; returns false and keeps the current map on error
+    bool loadErrorMap(const std::string& path);
+    // Remove the error map (matrix-only calibration)
+    void clearErrorMap();
+    // Copy of the current error map
+    ErrorMap getErrorMap() const;
+    // Apply calibration to input coordinates: the leading linear axes go through the matrix and the
+    // error map, the remaining ones through their axis mapping (pass-through by default)
     std::vector<double> applyCalibration(const std::vector<double>& coordinates) const;
+    // Allocation-free variant: writes count calibrated coordinates into a caller buffer
+    // (result may equal coordinates for in-place use). If versionUsed is given it receives the
+    // version of the calibration snapshot that produced the result.
+    void applyCalibration(const double* coordinates, double* result, std::size_t count,
+                          std::uint64_t* versionUsed = nullptr) const;
+    // Batch transform of count points in SoA layout (separate X and Y arrays).
+    // Output arrays may alias the inputs for in-place operation. With a 3D / 4D calibration
+    // the points are taken to lie at 0 on the further linear axes.
+    void applyCalibrationBatch(const double* xIn, const double* yIn,
+                               double* xOut, double* yOut, std::size_t count) const;
+    // Batch transform of count points in AoS layout: each point is `stride` consecutive doubles
+    // (X, Y, then pass-through coordinates). pointsOut may equal pointsIn for in-place operation.
+    void applyCalibrationBatch(const double* pointsIn, double* pointsOut,
+                               std::size_t count, std::size_t stride = 2) const;
+    // Convert stage coordinates back to world coordinates: the error-map correction is removed
+    // by fixed-point iteration, then the cached matrix inverse is applied
+    // (the matrix step passes coordinates through unchanged if the matrix is singular)
+    std::vector<double> applyInverseCalibration(const std::vector<double>& coordinates) const;
+    void applyInverseCalibration(const double* coordinates, double* result, std::size_t count) const;
+    // Batch inverse transform in SoA layout (outputs may alias inputs)
+    void applyInverseCalibrationBatch(const double* xIn, const double* yIn,
+                                      double* xOut, double* yOut, std::size_t count) const;
 };
 
 #endif // CALIBRATION_MANAGER_H
@@ -0,0 +1,288 @@
+#include "CalibrationSolver.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+using Mat3 = std::array<double, 9>;
+
+Mat3 multiply(const Mat3& a, const Mat3& b) {
+    Mat3 r{};
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            r[i * 3 + j] = a[i * 3] * b[j] + a[i * 3 + 1] * b[3 + j] + a[i * 3 + 2] * b[6 + j];
+        }
+    }
+    return r;
+}
+
+// Hartley normalization: move the centroid to the origin and scale the mean distance to sqrt(2)
+struct Normalizer {
+    double cx = 0.0, cy = 0.0, scale = 1.0;
+
+    bool compute(const double* xs, const double* ys, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            cx += xs[i];
+            cy += ys[i];
+        }
+        cx /= n;
+        cy /= n;
+        double meanDist = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            meanDist += std::hypot(xs[i] - cx, ys[i] - cy);
+        }
+        meanDist /= n;
+        if (!(meanDist > 0.0) || !std::isfinite(meanDist)) return false;
+        scale = std::sqrt(2.0) / meanDist;
+        return true;
+    }
+    Mat3 forward() const { return {scale, 0, -scale * cx, 0, scale, -scale * cy, 0, 0, 1}; }
+    Mat3 inverse() const { return {1.0 / scale, 0, cx, 0, 1.0 / scale, cy, 0, 0, 1}; }
+};
+
+// Solve the 3x3 system a * x = b by Gaussian elimination with partial pivoting
+bool solve3(std::array<double, 9> a, std::array<double, 3> b, std::array<double, 3>& x) {
+    double maxDiag = std::max({std::fabs(a[0]), std::fabs(a[4]), std::fabs(a[8])});
+    for (int col = 0; col < 3; ++col) {
+        int pivot = col;
+        for (int r = col + 1; r < 3; ++r) {
+            if (std::fabs(a[r * 3 + col]) > std::fabs(a[pivot * 3 + col])) pivot = r;
+        }
+        if (std::fabs(a[pivot * 3 + col]) <= 1e-10 * maxDiag) return false;
+        if (pivot != col) {
+            for (int k = 0; k < 3; ++k) std::swap(a[col * 3 + k], a[pivot * 3 + k]);
+            std::swap(b[col], b[pivot]);
+        }
+        for (int r = col + 1; r < 3; ++r) {
+            double f = a[r * 3 + col] / a[col * 3 + col];
+            for (int k = col; k < 3; ++k) a[r * 3 + k] -= f * a[col * 3 + k];
+            b[r] -= f * b[col];
+        }
+    }
+    for (int r = 2; r >= 0; --r) {
+        double sum = b[r];
+        for (int k = r + 1; k < 3; ++k) sum -= a[r * 3 + k] * x[k];
+        x[r] = sum / a[r * 3 + r];
+    }
+    return true;
+}
+
+// Cyclic Jacobi eigen-decomposition of a symmetric 9x9 matrix.
+// On return a's diagonal holds the eigenvalues and v's columns the eigenvectors.
+void jacobiEigen9(double a[9][9], double v[9][9]) {
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) v[i][j] = (i == j) ? 1.0 : 0.0;
+    }
+    for (int sweep = 0; sweep < 60; ++sweep) {
+        double off = 0.0, total = 0.0;
+        for (int i = 0; i < 9; ++i) {
+            for (int j = 0; j < 9; ++j) {
+                total += a[i][j] * a[i][j];
+                if (i != j) off += a[i][j] * a[i][j];
+            }
+        }
+        if (off <= 1e-30 * total) return;
+        for (int p = 0; p < 8; ++p) {
+            for (int q = p + 1; q < 9; ++q) {
+                if (a[p][q] == 0.0) continue;
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+                for (int k = 0; k < 9; ++k) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 9; ++k) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 9; ++k) {
+                    double vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+}
+
+std::size_t minimalSampleSize(FitOptions::Model model) {
+    return model == FitOptions::Model::Affine ? 3 : 4;
+}
+
+} // namespace
+
+double CalibrationSolver::residual(const std::array<double, 9>& m, const PointPair& pair) {
+    double x = m[0] * pair.worldX + m[1] * pair.worldY + m[2];
+    double y = m[3] * pair.worldX + m[4] * pair.worldY + m[5];
+    double w = m[6] * pair.worldX + m[7] * pair.worldY + m[8];
+    if (w != 0.0) {
+        x /= w;
+        y /= w;
+    }
+    return std::hypot(x - pair.stageX, y - pair.stageY);
+}
+
+bool CalibrationSolver::fitModel(const std::vector<PointPair>& pairs, const std::vector<std::size_t>& indices,
+                                 FitOptions::Model model, std::array<double, 9>& matrix) {
+    const std::size_t n = indices.size();
+    if (n < minimalSampleSize(model)) return false;
+    std::vector<double> wx(n), wy(n), sx(n), sy(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const PointPair& p = pairs[indices[i]];
+        wx[i] = p.worldX;
+        wy[i] = p.worldY;
+        sx[i] = p.stageX;
+        sy[i] = p.stageY;
+    }
+    Normalizer nw, ns;
+    if (!nw.compute(wx.data(), wy.data(), n) || !ns.compute(sx.data(), sy.data(), n)) return false;
+    for (std::size_t i = 0; i < n; ++i) {
+        wx[i] = (wx[i] - nw.cx) * nw.scale;
+        wy[i] = (wy[i] - nw.cy) * nw.scale;
+        sx[i] = (sx[i] - ns.cx) * ns.scale;
+        sy[i] = (sy[i] - ns.cy) * ns.scale;
+    }
+
+    Mat3 normalized;
+    if (model == FitOptions::Model::Affine) {
+        // Normal equations: both output rows share A^T A over [u v 1]
+        std::array<double, 9> ata{};
+        std::array<double, 3> rhsX{}, rhsY{};
+        for (std::size_t i = 0; i < n; ++i) {
+            const double row[3] = {wx[i], wy[i], 1.0};
+            for (int r = 0; r < 3; ++r) {
+                for (int c = 0; c < 3; ++c) ata[r * 3 + c] += row[r] * row[c];
+                rhsX[r] += row[r] * sx[i];
+                rhsY[r] += row[r] * sy[i];
+            }
+        }
+        std::array<double, 3> rowX, rowY;
+        if (!solve3(ata, rhsX, rowX) || !solve3(ata, rhsY, rowY)) return false;
+        normalized = {rowX[0], rowX[1], rowX[2], rowY[0], rowY[1], rowY[2], 0, 0, 1};
+    } else {
+        // Normalized DLT: the homography is the eigenvector of A^T A with the smallest eigenvalue
+        double ata[9][9] = {};
+        for (std::size_t i = 0; i < n; ++i) {
+            const double u = wx[i], v = wy[i], p = sx[i], q = sy[i];
+            const double r1[9] = {-u, -v, -1, 0, 0, 0, p * u, p * v, p};
+            const double r2[9] = {0, 0, 0, -u, -v, -1, q * u, q * v, q};
+            for (int r = 0; r < 9; ++r) {
+                for (int c = r; c < 9; ++c) ata[r][c] += r1[r] * r1[c] + r2[r] * r2[c];
+            }
+        }
+        for (int r = 0; r < 9; ++r) {
+            for (int c = 0; c < r; ++c) ata[r][c] = ata[c][r];
+        }
+        double vecs[9][9];
+        jacobiEigen9(ata, vecs);
+        int order[9] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+        std::sort(order, order + 9, [&ata](int a, int b) { return ata[a][a] < ata[b][b]; });
+        // A second (near-)null direction means the points do not pin down a unique homography
+        if (ata[order[1]][order[1]] <= 1e-10 * ata[order[8]][order[8]]) return false;
+        for (int k = 0; k < 9; ++k) normalized[k] = vecs[k][order[0]];
+    }
+
+    Mat3 m = multiply(ns.inverse(), multiply(normalized, nw.forward()));
+    if (model == FitOptions::Model::Affine) {
+        m[6] = 0.0;
+        m[7] = 0.0;
+        m[8] = 1.0;
+    } else {
+        if (std::fabs(m[8]) < 1e-12) return false;
+        double inv = 1.0 / m[8];
+        for (double& e : m) e *= inv;
+    }
+    for (double e : m) {
+        if (!std::isfinite(e)) return false;
+    }
+    matrix = m;
+    return true;
+}
+
+FitResult CalibrationSolver::fit(const std::vector<PointPair>& pairs, const FitOptions& options) {
+    FitResult result;
+    const std::size_t n = pairs.size();
+    const std::size_t sampleSize = minimalSampleSize(options.model);
+    if (n < sampleSize) return result;
+
+    std::vector<std::size_t> selected(n);
+    for (std::size_t i = 0; i < n; ++i) selected[i] = i;
+
+    if (options.useRansac) {
+        std::mt19937 rng(options.seed);
+        std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+        std::vector<std::size_t> sample(sampleSize);
+        Mat3 hypothesis, best;
+        std::size_t bestCount = 0;
+        long iterations = options.maxIterations;
+        for (long it = 0; it < iterations; ++it) {
+            for (std::size_t k = 0; k < sampleSize; ++k) {
+                std::size_t idx;
+                do {
+                    idx = pick(rng);
+                } while (std::find(sample.begin(), sample.begin() + k, idx) != sample.begin() + k);
+                sample[k] = idx;
+            }
+            if (!fitModel(pairs, sample, options.model, hypothesis)) continue;
+            std::size_t count = 0;
+            for (const auto& p : pairs) {
+                if (residual(hypothesis, p) <= options.inlierThreshold) ++count;
+            }
+            if (count > bestCount) {
+                bestCount = count;
+                best = hypothesis;
+                // Adaptive stopping: enough iterations to draw one all-inlier sample with `confidence`
+                double inlierRatio = static_cast<double>(count) / n;
+                double allInlier = std::pow(inlierRatio, static_cast<double>(sampleSize));
+                if (allInlier >= 1.0) break;
+                // log1p keeps a tiny allInlier from rounding the denominator to zero; a non-finite
+                // or non-positive estimate leaves the iteration budget alone
+                double needed = std::log(1.0 - options.confidence) / std::log1p(-allInlier);
+                if (std::isfinite(needed) && needed > 0.0 && needed < iterations) {
+                    needed = std::min(needed, static_cast<double>(options.maxIterations));
+                    iterations = std::max<long>(it + 1, static_cast<long>(std::ceil(needed)));
+                }
+            }
+        }
+        if (bestCount < sampleSize) return result;
+        selected.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            if (residual(best, pairs[i]) <= options.inlierThreshold) selected.push_back(i);
+        }
+    }
+
+    Mat3 matrix;
+    if (!fitModel(pairs, selected, options.model, matrix)) return result;
+    if (options.useRansac) {
+        // Refit once more on the inliers of the least-squares model
+        std::vector<std::size_t> refined;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (residual(matrix, pairs[i]) <= options.inlierThreshold) refined.push_back(i);
+        }
+        Mat3 refit;
+        if (refined.size() >= sampleSize && fitModel(pairs, refined, options.model, refit)) {
+            matrix = refit;
+            selected.swap(refined);
+        }
+    }
+
+    result.success = true;
+    result.matrix = matrix;
+    result.residuals.resize(n);
+    result.inliers.assign(n, false);
+    for (std::size_t i = 0; i < n; ++i) result.residuals[i] = residual(matrix, pairs[i]);
+    double sumSq = 0.0;
+    for (std::size_t idx : selected) {
+        result.inliers[idx] = true;
+        sumSq += result.residuals[idx] * result.residuals[idx];
+        result.maxError = std::max(result.maxError, result.residuals[idx]);
+    }
+    result.inlierCount = selected.size();
+    result.rmsError = std::sqrt(sumSq / selected.size());
+    return result;
+}
@@ -0,0 +1,49 @@
+#ifndef CALIBRATION_SOLVER_H
+#define CALIBRATION_SOLVER_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// One fiducial correspondence: where a mark is in world coordinates and where the stage saw it
+struct PointPair {
+    double worldX, worldY;
+    double stageX, stageY;
+};
+
+// Options for fitting a world -> stage calibration matrix
+struct FitOptions {
+    enum class Model { Affine, Homography };
+    Model model = Model::Affine;
+    bool useRansac = false;         // reject outliers before the final least-squares fit
+    double inlierThreshold = 0.01;  // RANSAC: max stage-space residual of an inlier
+    int maxIterations = 1000;       // RANSAC: upper bound on sampled hypotheses
+    double confidence = 0.999;      // RANSAC: stop early once this confidence is reached
+    unsigned seed = 12345;          // RANSAC: sampling seed (fits are reproducible)
+};
+
+// Outcome of a fit; matrix is only meaningful when success is true
+struct FitResult {
+    bool success = false;
+    std::array<double, 9> matrix = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    std::vector<double> residuals;  // stage-space error per input pair
+    std::vector<bool> inliers;      // pairs used by the final fit
+    std::size_t inlierCount = 0;
+    double rmsError = 0.0;          // over inliers
+    double maxError = 0.0;          // over inliers
+};
+
+// Least-squares estimation of calibration matrices from fiducial correspondences.
+// Affine fits solve the normal equations; homographies use the normalized DLT with the
+// 9x9 normal matrix and a Jacobi eigen-solver. Both are O(N) in the number of pairs.
+class CalibrationSolver {
+public:
+    static FitResult fit(const std::vector<PointPair>& pairs, const FitOptions& options = FitOptions());
+    // Fit using only the listed pairs; returns false for too few or degenerate points
+    static bool fitModel(const std::vector<PointPair>& pairs, const std::vector<std::size_t>& indices,
+                         FitOptions::Model model, std::array<double, 9>& matrix);
+    // Stage-space distance between the mapped world point and the observed stage point
+    static double residual(const std::array<double, 9>& matrix, const PointPair& pair);
+};
+
+#endif // CALIBRATION_SOLVER_H
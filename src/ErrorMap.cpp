@@ -0,0 +1,251 @@
+#include "ErrorMap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// File header of the binary error-map format, followed by cols*rows (dx, dy) float pairs
+const char kMagic[8] = {'C', 'M', 'L', 'E', 'M', 'A', 'P', '\0'};
+const std::uint32_t kFormatVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::int32_t cols;
+    std::int32_t rows;
+    std::uint32_t reserved;
+    double originX, originY;
+    double spacingX, spacingY;
+};
+
+// Bilinear interpolation inside one tile. Non-finite coordinates get no correction (a NaN
+// would otherwise turn into an out-of-range cell index).
+inline void interpolate(const float* cells, double originX, double originY,
+                        double invSpacingX, double invSpacingY, int cols, int rows,
+                        double x, double y, double& dx, double& dy) {
+    if (!std::isfinite(x) || !std::isfinite(y)) {
+        dx = 0.0;
+        dy = 0.0;
+        return;
+    }
+    double u = (x - originX) * invSpacingX;
+    double v = (y - originY) * invSpacingY;
+    double cu = std::min(std::max(std::floor(u), 0.0), static_cast<double>(cols - 2));
+    double cv = std::min(std::max(std::floor(v), 0.0), static_cast<double>(rows - 2));
+    double fx = std::min(std::max(u - cu, 0.0), 1.0);
+    double fy = std::min(std::max(v - cv, 0.0), 1.0);
+    const float* t = cells + (static_cast<std::size_t>(cv) * (cols - 1) + static_cast<std::size_t>(cu)) * 8;
+    double w00 = (1.0 - fx) * (1.0 - fy);
+    double w10 = fx * (1.0 - fy);
+    double w01 = (1.0 - fx) * fy;
+    double w11 = fx * fy;
+    dx = w00 * t[0] + w10 * t[1] + w01 * t[2] + w11 * t[3];
+    dy = w00 * t[4] + w10 * t[5] + w01 * t[6] + w11 * t[7];
+}
+
+#if defined(__AVX2__)
+// Four points per iteration: tile indices are computed in vector registers and the eight
+// tile values are fetched with gathers. Indices are 32-bit, so the caller only uses this
+// while the tile array has fewer than 2^31 entries. Returns the number of points processed.
+std::size_t correctBatchAvx2(const float* cells, double originX, double originY,
+                             double invSpacingX, double invSpacingY, int cols, int rows,
+                             double* xs, double* ys, std::size_t count) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d ox = _mm256_set1_pd(originX), oy = _mm256_set1_pd(originY);
+    const __m256d isx = _mm256_set1_pd(invSpacingX), isy = _mm256_set1_pd(invSpacingY);
+    const __m256d maxCu = _mm256_set1_pd(static_cast<double>(cols - 2));
+    const __m256d maxCv = _mm256_set1_pd(static_cast<double>(rows - 2));
+    const __m256d cellCols = _mm256_set1_pd(static_cast<double>(cols - 1));
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d x = _mm256_loadu_pd(xs + i);
+        __m256d y = _mm256_loadu_pd(ys + i);
+        // x - x is NaN for NaN and infinities: such lanes use cell 0 and get no correction
+        __m256d finite = _mm256_and_pd(_mm256_cmp_pd(_mm256_sub_pd(x, x), zero, _CMP_ORD_Q),
+                                       _mm256_cmp_pd(_mm256_sub_pd(y, y), zero, _CMP_ORD_Q));
+        __m256d u = _mm256_and_pd(_mm256_mul_pd(_mm256_sub_pd(x, ox), isx), finite);
+        __m256d v = _mm256_and_pd(_mm256_mul_pd(_mm256_sub_pd(y, oy), isy), finite);
+        __m256d cu = _mm256_min_pd(_mm256_max_pd(_mm256_floor_pd(u), zero), maxCu);
+        __m256d cv = _mm256_min_pd(_mm256_max_pd(_mm256_floor_pd(v), zero), maxCv);
+        __m256d fx = _mm256_min_pd(_mm256_max_pd(_mm256_sub_pd(u, cu), zero), one);
+        __m256d fy = _mm256_min_pd(_mm256_max_pd(_mm256_sub_pd(v, cv), zero), one);
+        __m128i tile = _mm256_cvttpd_epi32(_mm256_add_pd(_mm256_mul_pd(cv, cellCols), cu));
+        __m128i base = _mm_slli_epi32(tile, 3);
+        __m256d t[8];
+        for (int k = 0; k < 8; ++k) {
+            t[k] = _mm256_cvtps_pd(_mm_i32gather_ps(cells + k, base, 4));
+        }
+        __m256d gx = _mm256_sub_pd(one, fx), gy = _mm256_sub_pd(one, fy);
+        __m256d w00 = _mm256_mul_pd(gx, gy), w10 = _mm256_mul_pd(fx, gy);
+        __m256d w01 = _mm256_mul_pd(gx, fy), w11 = _mm256_mul_pd(fx, fy);
+        __m256d dx = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(w00, t[0]), _mm256_mul_pd(w10, t[1])),
+                                   _mm256_add_pd(_mm256_mul_pd(w01, t[2]), _mm256_mul_pd(w11, t[3])));
+        __m256d dy = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(w00, t[4]), _mm256_mul_pd(w10, t[5])),
+                                   _mm256_add_pd(_mm256_mul_pd(w01, t[6]), _mm256_mul_pd(w11, t[7])));
+        _mm256_storeu_pd(xs + i, _mm256_add_pd(x, _mm256_and_pd(dx, finite)));
+        _mm256_storeu_pd(ys + i, _mm256_add_pd(y, _mm256_and_pd(dy, finite)));
+    }
+    return i;
+}
+#endif
+
+} // namespace
+
+ErrorMap::ErrorMap()
+    : originX(0.0), originY(0.0), spacingX(1.0), spacingY(1.0),
+      invSpacingX(1.0), invSpacingY(1.0), cols(0), rows(0) {}
+
+bool ErrorMap::setGrid(double originX, double originY, double spacingX, double spacingY,
+                       int cols, int rows, const std::vector<float>& dx, const std::vector<float>& dy) {
+    if (cols < 2 || rows < 2) return false;
+    if (!std::isfinite(originX) || !std::isfinite(originY)) return false;
+    // A denormal spacing is positive but its reciprocal overflows; either way u/v could turn
+    // NaN in interpolate() and the cell index would be meaningless
+    if (!(spacingX > 0.0) || !(spacingY > 0.0) || !std::isfinite(spacingX) || !std::isfinite(spacingY) ||
+        !std::isfinite(1.0 / spacingX) || !std::isfinite(1.0 / spacingY)) {
+        return false;
+    }
+    std::size_t n = static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows);
+    if (dx.size() != n || dy.size() != n) return false;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!std::isfinite(dx[i]) || !std::isfinite(dy[i])) return false;
+    }
+    this->originX = originX;
+    this->originY = originY;
+    this->spacingX = spacingX;
+    this->spacingY = spacingY;
+    invSpacingX = 1.0 / spacingX;
+    invSpacingY = 1.0 / spacingY;
+    this->cols = cols;
+    this->rows = rows;
+    nodes.resize(2 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        nodes[2 * i] = dx[i];
+        nodes[2 * i + 1] = dy[i];
+    }
+    buildTiles();
+    return true;
+}
+
+void ErrorMap::buildTiles() {
+    std::size_t cellCols = static_cast<std::size_t>(cols - 1);
+    std::size_t cellRows = static_cast<std::size_t>(rows - 1);
+    cells.assign(cellCols * cellRows * 8, 0.0f);
+    auto node = [this](std::size_t c, std::size_t r, int comp) {
+        return nodes[2 * (r * static_cast<std::size_t>(cols) + c) + comp];
+    };
+    for (std::size_t r = 0; r < cellRows; ++r) {
+        for (std::size_t c = 0; c < cellCols; ++c) {
+            float* t = &cells[(r * cellCols + c) * 8];
+            for (int comp = 0; comp < 2; ++comp) {
+                t[comp * 4 + 0] = node(c, r, comp);
+                t[comp * 4 + 1] = node(c + 1, r, comp);
+                t[comp * 4 + 2] = node(c, r + 1, comp);
+                t[comp * 4 + 3] = node(c + 1, r + 1, comp);
+            }
+        }
+    }
+}
+
+bool ErrorMap::loadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion) {
+        return false;
+    }
+    if (header.cols < 2 || header.rows < 2 || header.cols > 65536 || header.rows > 65536) return false;
+    std::size_t n = static_cast<std::size_t>(header.cols) * static_cast<std::size_t>(header.rows);
+    // The header must not make us allocate more than the file actually holds
+    const std::streampos dataStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streampos fileEnd = file.tellg();
+    if (dataStart < 0 || fileEnd < dataStart ||
+        static_cast<std::uint64_t>(fileEnd - dataStart) < static_cast<std::uint64_t>(n) * 2 * sizeof(float)) {
+        return false;
+    }
+    file.seekg(dataStart);
+    std::vector<float> interleaved(2 * n);
+    if (!file.read(reinterpret_cast<char*>(interleaved.data()),
+                   static_cast<std::streamsize>(interleaved.size() * sizeof(float)))) {
+        return false;
+    }
+    std::vector<float> dx(n), dy(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        dx[i] = interleaved[2 * i];
+        dy[i] = interleaved[2 * i + 1];
+    }
+    return setGrid(header.originX, header.originY, header.spacingX, header.spacingY,
+                   header.cols, header.rows, dx, dy);
+}
+
+bool ErrorMap::saveToFile(const std::string& path) const {
+    if (isEmpty()) return false;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.cols = cols;
+    header.rows = rows;
+    header.reserved = 0;
+    header.originX = originX;
+    header.originY = originY;
+    header.spacingX = spacingX;
+    header.spacingY = spacingY;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(nodes.data()),
+               static_cast<std::streamsize>(nodes.size() * sizeof(float)));
+    return static_cast<bool>(file);
+}
+
+bool ErrorMap::isEmpty() const {
+    return cells.empty();
+}
+
+void ErrorMap::clear() {
+    cols = 0;
+    rows = 0;
+    nodes.clear();
+    cells.clear();
+}
+
+void ErrorMap::lookup(double x, double y, double& dx, double& dy) const {
+    if (cells.empty()) {
+        dx = 0.0;
+        dy = 0.0;
+        return;
+    }
+    interpolate(cells.data(), originX, originY, invSpacingX, invSpacingY, cols, rows, x, y, dx, dy);
+}
+
+void ErrorMap::correctBatch(double* xs, double* ys, std::size_t count) const {
+    if (cells.empty()) return;
+    // Hoist members into locals so the loop body has no aliasing through `this`
+    const float* c = cells.data();
+    const double ox = originX, oy = originY, isx = invSpacingX, isy = invSpacingY;
+    const int nc = cols, nr = rows;
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    if (cells.size() <= static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+        i = correctBatchAvx2(c, ox, oy, isx, isy, nc, nr, xs, ys, count);
+    }
+#endif
+    // Scalar path (and the tail of the AVX2 path); the finite check keeps it from auto-vectorizing
+    for (; i < count; ++i) {
+        double dx, dy;
+        interpolate(c, ox, oy, isx, isy, nc, nr, xs[i], ys[i], dx, dy);
+        xs[i] += dx;
+        ys[i] += dy;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef ERROR_MAP_H
+#define ERROR_MAP_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 2D stage error map: dx/dy corrections sampled on a regular lattice and bilinearly
+// interpolated. CalibrationManager applies it after the calibration matrix, so the lattice and
+// the looked-up points are in stage coordinates, not world coordinates.
+// Points outside the lattice use the nearest edge cell (clamped).
+// Storage is tiled per cell: the four corner deltas of a cell (8 floats, 32 bytes) are
+// contiguous, so one lookup touches a single cache line regardless of the grid width.
+class ErrorMap {
+private:
+    double originX, originY;   // stage position (post-matrix) of lattice node (0, 0)
+    double spacingX, spacingY; // lattice pitch
+    double invSpacingX, invSpacingY;
+    int cols, rows;            // lattice nodes per row / column (>= 2 when loaded)
+    std::vector<float> nodes;  // node deltas (dx, dy), row-major, as loaded
+    std::vector<float> cells;  // per-cell tiles: dx00 dx10 dx01 dx11 dy00 dy10 dy01 dy11
+
+    void buildTiles();
+public:
+    ErrorMap();
+    // Define the lattice; dx/dy hold cols*rows node values in row-major order.
+    // Returns false (and leaves the map unchanged) on inconsistent dimensions, a non-finite
+    // origin, a spacing without a finite reciprocal, or a non-finite node delta.
+    bool setGrid(double originX, double originY, double spacingX, double spacingY,
+                 int cols, int rows, const std::vector<float>& dx, const std::vector<float>& dy);
+    // Load from / save to the compact binary format (header + interleaved float dx/dy per node)
+    bool loadFromFile(const std::string& path);
+    bool saveToFile(const std::string& path) const;
+    // Whether a lattice is loaded (an empty map applies no correction)
+    bool isEmpty() const;
+    // Remove the lattice
+    void clear();
+    // Interpolated correction (dx, dy) at a point; zero for a non-finite point
+    void lookup(double x, double y, double& dx, double& dy) const;
+    // Add the interpolated correction to each point in place (SoA layout); non-finite points are
+    // left unchanged. Built with AVX2, four points are corrected per step using gathers;
+    // otherwise the loop is scalar.
+    void correctBatch(double* xs, double* ys, std::size_t count) const;
+    int getCols() const { return cols; }
+    int getRows() const { return rows; }
+};
+
+#endif // ERROR_MAP_H
@@ -0,0 +1,163 @@
+#include "EventLog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+// Export file header: magic, format version, record size and record count
+const char kMagic[8] = {'C', 'M', 'L', 'E', 'V', 'T', 'S', '\0'};
+const std::uint32_t kFormatVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint64_t recordCount;
+};
+
+// Number of usable values; guards against records that did not come from record()
+std::size_t validValues(const EventRecord& rec) {
+    return std::min<std::size_t>(rec.valueCount, EventRecord::kMaxValues);
+}
+
+std::string formatList(const EventRecord& rec, std::size_t first, std::size_t n) {
+    n = std::min(n, first < validValues(rec) ? validValues(rec) - first : 0);
+    std::string out = "[";
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i > 0) out += ",";
+        out += std::to_string(rec.values[first + i]);
+    }
+    out += "]";
+    return out;
+}
+
+} // namespace
+
+EventLog::EventLog(std::size_t capacity) : next(0), count(0), overwritten(0) {
+    if (capacity < 1) capacity = 1;
+    records.resize(capacity);
+}
+
+void EventLog::record(EventId id, int axis, const double* values, std::size_t valueCount) {
+    EventRecord& rec = records[next];
+    rec.timestampNs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    rec.id = static_cast<std::uint16_t>(id);
+    rec.axis = static_cast<std::int16_t>(axis);
+    if (valueCount > EventRecord::kMaxValues) valueCount = EventRecord::kMaxValues;
+    rec.valueCount = static_cast<std::uint16_t>(valueCount);
+    rec.reserved = 0;
+    for (std::size_t i = 0; i < valueCount; ++i) {
+        rec.values[i] = values[i];
+    }
+    next = (next + 1 == records.size()) ? 0 : next + 1;
+    if (count < records.size()) {
+        ++count;
+    } else {
+        ++overwritten;
+    }
+}
+
+std::size_t EventLog::size() const {
+    return count;
+}
+
+std::size_t EventLog::overwrittenCount() const {
+    return overwritten;
+}
+
+std::vector<EventRecord> EventLog::getRecords() const {
+    std::vector<EventRecord> out;
+    out.reserve(count);
+    std::size_t start = (next + records.size() - count) % records.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        out.push_back(records[(start + i) % records.size()]);
+    }
+    return out;
+}
+
+std::vector<std::string> EventLog::formatAll() const {
+    std::vector<std::string> out;
+    for (const auto& rec : getRecords()) {
+        out.push_back(format(rec));
+    }
+    return out;
+}
+
+void EventLog::clear() {
+    next = 0;
+    count = 0;
+    overwritten = 0;
+}
+
+bool EventLog::exportBinary(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    std::vector<EventRecord> recs = getRecords();
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.recordSize = sizeof(EventRecord);
+    header.recordCount = recs.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(recs.data()),
+               static_cast<std::streamsize>(recs.size() * sizeof(EventRecord)));
+    return static_cast<bool>(file);
+}
+
+bool EventLog::importBinary(const std::string& path, std::vector<EventRecord>& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kFormatVersion || header.recordSize != sizeof(EventRecord)) {
+        return false;
+    }
+    // The header must describe exactly the records that follow it; never size the buffer from
+    // an unchecked count
+    const std::streamoff dataStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streamoff dataEnd = file.tellg();
+    if (dataStart < 0 || dataEnd < dataStart ||
+        static_cast<std::uint64_t>(dataEnd - dataStart) / sizeof(EventRecord) != header.recordCount ||
+        static_cast<std::uint64_t>(dataEnd - dataStart) % sizeof(EventRecord) != 0) {
+        return false;
+    }
+    file.seekg(dataStart);
+    out.resize(static_cast<std::size_t>(header.recordCount));
+    file.read(reinterpret_cast<char*>(out.data()),
+              static_cast<std::streamsize>(out.size() * sizeof(EventRecord)));
+    bool valid = static_cast<bool>(file);
+    for (std::size_t i = 0; valid && i < out.size(); ++i) {
+        valid = out[i].valueCount <= EventRecord::kMaxValues;
+    }
+    if (!valid) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+std::string EventLog::format(const EventRecord& rec) {
+    switch (static_cast<EventId>(rec.id)) {
+    case EventId::CalibrationApplied:
+        if (rec.valueCount >= 4) {
+            return "Applied calibration transform: " + formatList(rec, 0, 2) + " -> " + formatList(rec, 2, 2);
+        }
+        return "Applied calibration transform to target positions";
+    case EventId::MoveStarted:
+        return "Moving to positions: " + formatList(rec, 0, validValues(rec));
+    case EventId::MoveCompleted:
+        if (rec.valueCount >= 1) {
+            return "Move completed (calibration v" + std::to_string(static_cast<std::uint64_t>(rec.values[0])) + ")";
+        }
+        return "Move completed";
+    case EventId::AxisMoveFailed:
+        return "Error moving axis " + std::to_string(rec.axis + 1) + " to position " +
+               (rec.valueCount > 0 ? std::to_string(rec.values[0]) : std::string("?"));
+    }
+    return "Unknown event " + std::to_string(rec.id);
+}
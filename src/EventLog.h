@@ -0,0 +1,61 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Structured event identifiers recorded on the motion hot path
+enum class EventId : std::uint16_t {
+    CalibrationApplied = 1, // values: world x, world y, stage x, stage y (none for single-axis systems)
+    MoveStarted        = 2, // values: commanded stage positions (first kMaxValues axes)
+    MoveCompleted      = 3, // optional: calibration version used by the move
+    AxisMoveFailed     = 4  // axis: failing axis index, values: commanded position
+};
+
+// Fixed-size binary event record (no heap data, safe to write to disk as-is)
+struct EventRecord {
+    static constexpr std::size_t kMaxValues = 4;
+    std::uint64_t timestampNs;   // steady_clock time since its epoch
+    std::uint16_t id;            // EventId
+    std::int16_t axis;           // axis index, or -1 when the event is not axis specific
+    std::uint16_t valueCount;    // number of valid entries in values
+    std::uint16_t reserved;
+    double values[kMaxValues];
+};
+static_assert(sizeof(EventRecord) == 48, "EventRecord layout is part of the export format");
+
+// Preallocated ring of binary event records; text is only produced when records are read.
+// Single writer: record() must not race with other calls on the same instance.
+class EventLog {
+private:
+    std::vector<EventRecord> records;
+    std::size_t next;        // index of the slot written by the next record()
+    std::size_t count;       // number of valid records (<= capacity)
+    std::size_t overwritten; // records lost because the ring wrapped
+public:
+    explicit EventLog(std::size_t capacity = 4096);
+    // Append an event (overwrites the oldest record when full; never allocates)
+    void record(EventId id, int axis = -1, const double* values = nullptr, std::size_t valueCount = 0);
+    // Number of records currently held
+    std::size_t size() const;
+    // Number of records overwritten since construction or the last clear()
+    std::size_t overwrittenCount() const;
+    // Copy out the held records, oldest first
+    std::vector<EventRecord> getRecords() const;
+    // Format the held records as text, oldest first
+    std::vector<std::string> formatAll() const;
+    // Drop all records
+    void clear();
+    // Write the held records to a binary file (header + raw records); returns false on I/O error
+    bool exportBinary(const std::string& path) const;
+    // Read records previously written by exportBinary; returns false on I/O or format error,
+    // including a record count that does not match the file size or a record with more than
+    // kMaxValues values
+    static bool importBinary(const std::string& path, std::vector<EventRecord>& out);
+    // Render a single record as the equivalent Logger message (at most kMaxValues values are read)
+    static std::string format(const EventRecord& rec);
+};
+
+#endif // EVENT_LOG_H
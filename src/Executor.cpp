@@ -0,0 +1,79 @@
+#include "Executor.h"
+
+namespace {
+thread_local Executor* currentExecutor = nullptr;
+
+// Marks the executor as current for the calling thread while it runs tasks
+class CurrentScope {
+private:
+    Executor* previous;
+public:
+    explicit CurrentScope(Executor* executor) : previous(currentExecutor) { currentExecutor = executor; }
+    ~CurrentScope() { currentExecutor = previous; }
+};
+} // namespace
+
+Executor::Executor() : outstanding(0), stopping(false) {}
+
+// Notifications are sent with the lock held: a task or finishWork() arriving from another thread
+// can be what lets run() return, and the executor may be destroyed as soon as it does
+void Executor::post(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mtx);
+    tasks.push_back(std::move(task));
+    cv.notify_one();
+}
+
+void Executor::run() {
+    CurrentScope scope(this);
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;) {
+        cv.wait(lock, [this] { return stopping || !tasks.empty() || outstanding == 0; });
+        if (stopping || tasks.empty()) break;
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+std::size_t Executor::poll() {
+    CurrentScope scope(this);
+    std::size_t count = 0;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!tasks.empty()) {
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        task();
+        ++count;
+        lock.lock();
+    }
+    return count;
+}
+
+void Executor::stop() {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+    cv.notify_all();
+}
+
+void Executor::restart() {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = false;
+}
+
+void Executor::addWork() {
+    std::lock_guard<std::mutex> lock(mtx);
+    ++outstanding;
+}
+
+void Executor::finishWork() {
+    std::lock_guard<std::mutex> lock(mtx);
+    --outstanding;
+    cv.notify_all();
+}
+
+Executor* Executor::current() {
+    return currentExecutor;
+}
@@ -0,0 +1,42 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// Small single-threaded executor: tasks posted from any thread run in order on the thread that
+// calls run(). Trigger and motion awaiters post coroutine resumptions here, so many inspection
+// recipes can share one thread. Outstanding work (e.g. a suspended recipe) keeps run() alive.
+class Executor {
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    std::size_t outstanding;  // work items that will post more tasks later
+    bool stopping;
+public:
+    Executor();
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+    // Queue a task (thread-safe)
+    void post(std::function<void()> task);
+    // Run tasks until stop() is called, or no tasks are queued and no work is outstanding
+    void run();
+    // Run the tasks that are ready now without blocking; returns how many ran
+    std::size_t poll();
+    // Make run() return after the current task. The request stays in force, also for a stop()
+    // issued before run() is entered, until restart().
+    void stop();
+    // Clear a previous stop() so run() processes tasks again
+    void restart();
+    // Register / complete outstanding work that keeps run() waiting for tasks
+    void addWork();
+    void finishWork();
+    // Executor running on the calling thread (nullptr outside run()/poll())
+    static Executor* current();
+};
+
+#endif // EXECUTOR_H
@@ -0,0 +1,487 @@
+#include "KeepOutZones.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+// Clip the parameter range [tEnter, tExit] of p + t * d to lo <= coordinate <= hi
+bool clipSlab(double p, double d, double lo, double hi, double& tEnter, double& tExit) {
+    if (d == 0.0) return p >= lo && p <= hi;
+    double ta = (lo - p) / d;
+    double tb = (hi - p) / d;
+    if (ta > tb) std::swap(ta, tb);
+    tEnter = std::max(tEnter, ta);
+    tExit = std::min(tExit, tb);
+    return tEnter <= tExit;
+}
+
+double surfaceArea(const double* lo, const double* hi) {
+    double dx = hi[0] - lo[0], dy = hi[1] - lo[1], dz = hi[2] - lo[2];
+    return 2.0 * (dx * dy + dy * dz + dz * dx);
+}
+
+// Point in a closed polygon: on an edge counts as inside, otherwise even-odd rule
+bool pointInPolygon(const std::vector<double>& v, double x, double y) {
+    const std::size_t n = v.size() / 2;
+    bool inside = false;
+    for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+        double xi = v[2 * i], yi = v[2 * i + 1];
+        double xj = v[2 * j], yj = v[2 * j + 1];
+        double cross = (xj - xi) * (y - yi) - (yj - yi) * (x - xi);
+        if (cross == 0.0 && x >= std::min(xi, xj) && x <= std::max(xi, xj) &&
+            y >= std::min(yi, yj) && y <= std::max(yi, yj)) {
+            return true;
+        }
+        if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi) inside = !inside;
+    }
+    return inside;
+}
+
+bool allFinite(const double* values, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!std::isfinite(values[i])) return false;
+    }
+    return true;
+}
+
+void toPoint3(const double* in, std::size_t count, double* out) {
+    for (std::size_t i = 0; i < 3; ++i) out[i] = (i < count) ? in[i] : 0.0;
+}
+
+// Remaining tokens of a line as numbers; false on anything that is not a finite number
+bool parseNumbers(std::istringstream& line, std::vector<double>& out) {
+    std::string token;
+    while (line >> token) {
+        char* end = nullptr;
+        double value = std::strtod(token.c_str(), &end);
+        if (end == token.c_str() || *end != '\0' || !std::isfinite(value)) return false;
+        out.push_back(value);
+    }
+    return true;
+}
+
+} // namespace
+
+KeepOutZones::KeepOutZones() : freeNodes(kNull), root(kNull), zoneCount(0) {}
+
+int KeepOutZones::allocateNode() {
+    int node;
+    if (freeNodes != kNull) {
+        node = freeNodes;
+        freeNodes = nodes[node].parent;
+    } else {
+        node = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+    }
+    Node& n = nodes[node];
+    n.parent = n.left = n.right = kNull;
+    n.zone = kNull;
+    n.height = 0;
+    return node;
+}
+
+void KeepOutZones::releaseNode(int node) {
+    nodes[node].parent = freeNodes;
+    nodes[node].height = -1;
+    freeNodes = node;
+}
+
+void KeepOutZones::refitUpwards(int node) {
+    while (node != kNull) {
+        Node& n = nodes[node];
+        const Node& a = nodes[n.left];
+        const Node& b = nodes[n.right];
+        for (int i = 0; i < 3; ++i) {
+            n.lo[i] = std::min(a.lo[i], b.lo[i]);
+            n.hi[i] = std::max(a.hi[i], b.hi[i]);
+        }
+        n.height = 1 + std::max(a.height, b.height);
+        node = n.parent;
+    }
+}
+
+void KeepOutZones::insertLeaf(int leaf) {
+    if (root == kNull) {
+        root = leaf;
+        nodes[leaf].parent = kNull;
+        return;
+    }
+    // Descend towards the sibling that grows the total surface area least
+    double lo[3], hi[3];
+    int index = root;
+    while (nodes[index].left != kNull) {
+        const Node& n = nodes[index];
+        for (int i = 0; i < 3; ++i) {
+            lo[i] = std::min(n.lo[i], nodes[leaf].lo[i]);
+            hi[i] = std::max(n.hi[i], nodes[leaf].hi[i]);
+        }
+        double area = surfaceArea(n.lo, n.hi);
+        double combined = surfaceArea(lo, hi);
+        double cost = 2.0 * combined;            // new parent of this node and the leaf
+        double inheritance = 2.0 * (combined - area);
+        double childCost[2];
+        const int children[2] = {n.left, n.right};
+        for (int c = 0; c < 2; ++c) {
+            const Node& child = nodes[children[c]];
+            for (int i = 0; i < 3; ++i) {
+                lo[i] = std::min(child.lo[i], nodes[leaf].lo[i]);
+                hi[i] = std::max(child.hi[i], nodes[leaf].hi[i]);
+            }
+            childCost[c] = surfaceArea(lo, hi) + inheritance;
+            if (child.left != kNull) childCost[c] -= surfaceArea(child.lo, child.hi);
+        }
+        if (cost < childCost[0] && cost < childCost[1]) break;
+        index = (childCost[0] < childCost[1]) ? n.left : n.right;
+    }
+    const int sibling = index;
+    const int oldParent = nodes[sibling].parent;
+    const int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    if (oldParent == kNull) {
+        root = newParent;
+    } else if (nodes[oldParent].left == sibling) {
+        nodes[oldParent].left = newParent;
+    } else {
+        nodes[oldParent].right = newParent;
+    }
+    refitUpwards(newParent);
+}
+
+void KeepOutZones::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = kNull;
+        return;
+    }
+    const int parent = nodes[leaf].parent;
+    const int grandParent = nodes[parent].parent;
+    const int sibling = (nodes[parent].left == leaf) ? nodes[parent].right : nodes[parent].left;
+    nodes[sibling].parent = grandParent;
+    if (grandParent == kNull) {
+        root = sibling;
+    } else {
+        if (nodes[grandParent].left == parent) nodes[grandParent].left = sibling;
+        else nodes[grandParent].right = sibling;
+    }
+    releaseNode(parent);
+    refitUpwards(grandParent);
+}
+
+int KeepOutZones::addZone(Zone zone) {
+    int id;
+    if (!freeZones.empty()) {
+        id = freeZones.back();
+        freeZones.pop_back();
+    } else {
+        id = static_cast<int>(zones.size());
+        zones.emplace_back();
+    }
+    const int leaf = allocateNode();
+    for (int i = 0; i < 3; ++i) {
+        nodes[leaf].lo[i] = zone.lo[i];
+        nodes[leaf].hi[i] = zone.hi[i];
+    }
+    nodes[leaf].zone = id;
+    zone.leaf = leaf;
+    zones[id] = std::move(zone);
+    ++zoneCount;
+    insertLeaf(leaf);
+    // Incremental inserts do not rebalance; fall back to a full rebuild once the tree
+    // is clearly deeper than a balanced one would be
+    int limit = 8;
+    for (std::size_t n = zoneCount; n > 1; n >>= 1) limit += 2;
+    if (nodes[root].height > limit) rebuild();
+    return id;
+}
+
+int KeepOutZones::addBox(const double minCorner[3], const double maxCorner[3]) {
+    if (!allFinite(minCorner, 3) || !allFinite(maxCorner, 3)) return -1;
+    Zone zone{};
+    zone.shape = Shape::Box;
+    for (int i = 0; i < 3; ++i) {
+        if (minCorner[i] > maxCorner[i]) return -1;
+        zone.lo[i] = minCorner[i];
+        zone.hi[i] = maxCorner[i];
+    }
+    return addZone(std::move(zone));
+}
+
+int KeepOutZones::addCylinder(double cx, double cy, double radius, double zMin, double zMax) {
+    const double values[5] = {cx, cy, radius, zMin, zMax};
+    if (!allFinite(values, 5) || !(radius > 0.0) || zMin > zMax) return -1;
+    Zone zone{};
+    zone.shape = Shape::Cylinder;
+    zone.cx = cx;
+    zone.cy = cy;
+    zone.radius = radius;
+    zone.lo[0] = cx - radius;
+    zone.hi[0] = cx + radius;
+    zone.lo[1] = cy - radius;
+    zone.hi[1] = cy + radius;
+    zone.lo[2] = zMin;
+    zone.hi[2] = zMax;
+    return addZone(std::move(zone));
+}
+
+int KeepOutZones::addPolygon(const std::vector<double>& xy, double zMin, double zMax) {
+    if (xy.size() < 6 || xy.size() % 2 != 0 || !allFinite(xy.data(), xy.size())) return -1;
+    if (!std::isfinite(zMin) || !std::isfinite(zMax) || zMin > zMax) return -1;
+    Zone zone{};
+    zone.shape = Shape::Polygon;
+    zone.vertices = xy;
+    zone.lo[0] = zone.hi[0] = xy[0];
+    zone.lo[1] = zone.hi[1] = xy[1];
+    for (std::size_t i = 2; i < xy.size(); i += 2) {
+        zone.lo[0] = std::min(zone.lo[0], xy[i]);
+        zone.hi[0] = std::max(zone.hi[0], xy[i]);
+        zone.lo[1] = std::min(zone.lo[1], xy[i + 1]);
+        zone.hi[1] = std::max(zone.hi[1], xy[i + 1]);
+    }
+    zone.lo[2] = zMin;
+    zone.hi[2] = zMax;
+    return addZone(std::move(zone));
+}
+
+bool KeepOutZones::removeZone(int id) {
+    if (id < 0 || id >= static_cast<int>(zones.size()) || zones[id].leaf == kNull) return false;
+    const int leaf = zones[id].leaf;
+    removeLeaf(leaf);
+    releaseNode(leaf);
+    zones[id].leaf = kNull;
+    zones[id].vertices.clear();
+    freeZones.push_back(id);
+    --zoneCount;
+    return true;
+}
+
+void KeepOutZones::clear() {
+    zones.clear();
+    freeZones.clear();
+    nodes.clear();
+    freeNodes = kNull;
+    root = kNull;
+    zoneCount = 0;
+}
+
+bool KeepOutZones::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return false;
+    KeepOutZones loaded;
+    std::string text;
+    while (std::getline(file, text)) {
+        std::string::size_type comment = text.find('#');
+        if (comment != std::string::npos) text.erase(comment);
+        std::istringstream line(text);
+        std::string keyword;
+        if (!(line >> keyword)) continue;
+        std::vector<double> v;
+        if (!parseNumbers(line, v)) return false;
+        int id = -1;
+        if (keyword == "box" && v.size() == 6) {
+            id = loaded.addBox(&v[0], &v[3]);
+        } else if (keyword == "cylinder" && v.size() == 5) {
+            id = loaded.addCylinder(v[0], v[1], v[2], v[3], v[4]);
+        } else if (keyword == "polygon" && v.size() >= 2) {
+            id = loaded.addPolygon(std::vector<double>(v.begin() + 2, v.end()), v[0], v[1]);
+        }
+        if (id < 0) return false;
+    }
+    if (file.bad()) return false;
+    loaded.rebuild();
+    *this = std::move(loaded);
+    return true;
+}
+
+int KeepOutZones::buildRange(int* leaves, int count) {
+    if (count == 1) return leaves[0];
+    // Split at the median centroid along the widest axis of the centroids
+    double lo[3], hi[3];
+    for (int i = 0; i < 3; ++i) {
+        lo[i] = hi[i] = nodes[leaves[0]].lo[i] + nodes[leaves[0]].hi[i];
+    }
+    for (int k = 1; k < count; ++k) {
+        for (int i = 0; i < 3; ++i) {
+            double c = nodes[leaves[k]].lo[i] + nodes[leaves[k]].hi[i];
+            lo[i] = std::min(lo[i], c);
+            hi[i] = std::max(hi[i], c);
+        }
+    }
+    int axis = 0;
+    for (int i = 1; i < 3; ++i) {
+        if (hi[i] - lo[i] > hi[axis] - lo[axis]) axis = i;
+    }
+    const int half = count / 2;
+    std::nth_element(leaves, leaves + half, leaves + count, [this, axis](int a, int b) {
+        return nodes[a].lo[axis] + nodes[a].hi[axis] < nodes[b].lo[axis] + nodes[b].hi[axis];
+    });
+    const int left = buildRange(leaves, half);
+    const int right = buildRange(leaves + half, count - half);
+    const int node = allocateNode();
+    nodes[node].left = left;
+    nodes[node].right = right;
+    nodes[left].parent = node;
+    nodes[right].parent = node;
+    Node& n = nodes[node];
+    for (int i = 0; i < 3; ++i) {
+        n.lo[i] = std::min(nodes[left].lo[i], nodes[right].lo[i]);
+        n.hi[i] = std::max(nodes[left].hi[i], nodes[right].hi[i]);
+    }
+    n.height = 1 + std::max(nodes[left].height, nodes[right].height);
+    return node;
+}
+
+void KeepOutZones::rebuild() {
+    nodes.clear();
+    freeNodes = kNull;
+    root = kNull;
+    if (zoneCount == 0) return;
+    std::vector<int> leaves;
+    leaves.reserve(zoneCount);
+    nodes.reserve(2 * zoneCount);
+    for (std::size_t id = 0; id < zones.size(); ++id) {
+        Zone& zone = zones[id];
+        if (zone.leaf == kNull) continue;
+        const int leaf = allocateNode();
+        for (int i = 0; i < 3; ++i) {
+            nodes[leaf].lo[i] = zone.lo[i];
+            nodes[leaf].hi[i] = zone.hi[i];
+        }
+        nodes[leaf].zone = static_cast<int>(id);
+        zone.leaf = leaf;
+        leaves.push_back(leaf);
+    }
+    root = buildRange(leaves.data(), static_cast<int>(leaves.size()));
+    nodes[root].parent = kNull;
+}
+
+int KeepOutZones::treeHeight() const {
+    return (root == kNull) ? -1 : nodes[root].height;
+}
+
+bool KeepOutZones::intersectZone(const Zone& zone, const double* p0, const double* p1, double& t) {
+    const double d[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    double t0 = 0.0, t1 = 1.0;
+    // The bounding box is exact for a box and a valid first cut for the other shapes
+    for (int i = 0; i < 3; ++i) {
+        if (!clipSlab(p0[i], d[i], zone.lo[i], zone.hi[i], t0, t1)) return false;
+    }
+    switch (zone.shape) {
+    case Shape::Box:
+        break;
+    case Shape::Cylinder: {
+        const double fx = p0[0] - zone.cx, fy = p0[1] - zone.cy;
+        const double a = d[0] * d[0] + d[1] * d[1];
+        const double b = 2.0 * (fx * d[0] + fy * d[1]);
+        const double c = fx * fx + fy * fy - zone.radius * zone.radius;
+        if (a == 0.0) {
+            if (c > 0.0) return false; // moves along Z outside the circle
+            break;
+        }
+        const double disc = b * b - 4.0 * a * c;
+        if (disc < 0.0) return false;
+        const double s = std::sqrt(disc);
+        t0 = std::max(t0, (-b - s) / (2.0 * a));
+        t1 = std::min(t1, (-b + s) / (2.0 * a));
+        if (t0 > t1) return false;
+        break;
+    }
+    case Shape::Polygon: {
+        const std::vector<double>& v = zone.vertices;
+        if (pointInPolygon(v, p0[0] + t0 * d[0], p0[1] + t0 * d[1])) break;
+        // Outside at t0: the segment enters where it first crosses an edge
+        const double dd = d[0] * d[0] + d[1] * d[1];
+        double first = t1 + 1.0;
+        const std::size_t n = v.size() / 2;
+        for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+            const double ex = v[2 * i] - v[2 * j], ey = v[2 * i + 1] - v[2 * j + 1];
+            const double wx = v[2 * j] - p0[0], wy = v[2 * j + 1] - p0[1];
+            const double denom = d[0] * ey - d[1] * ex;
+            const double wCrossD = wx * d[1] - wy * d[0];
+            if (denom != 0.0) {
+                const double s = (wx * ey - wy * ex) / denom;
+                const double u = wCrossD / denom;
+                if (u >= 0.0 && u <= 1.0 && s >= t0 && s <= t1) first = std::min(first, s);
+            } else if (wCrossD == 0.0 && dd > 0.0) {
+                // Collinear with the edge: first overlap of the two parameter ranges
+                const double sa = (wx * d[0] + wy * d[1]) / dd;
+                const double sb = ((wx + ex) * d[0] + (wy + ey) * d[1]) / dd;
+                const double lo = std::max(std::min(sa, sb), t0);
+                const double hi = std::min(std::max(sa, sb), t1);
+                if (lo <= hi) first = std::min(first, lo);
+            }
+        }
+        if (first > t1) return false;
+        t0 = first;
+        break;
+    }
+    }
+    t = t0;
+    return true;
+}
+
+int KeepOutZones::findZone(const double* point, std::size_t count) const {
+    double p[3];
+    toPoint3(point, count, p);
+    if (root == kNull) return -1;
+    int stack[128];
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+        const Node& n = nodes[stack[--top]];
+        if (p[0] < n.lo[0] || p[0] > n.hi[0] || p[1] < n.lo[1] || p[1] > n.hi[1] ||
+            p[2] < n.lo[2] || p[2] > n.hi[2]) {
+            continue;
+        }
+        if (n.left == kNull) {
+            double t;
+            if (intersectZone(zones[n.zone], p, p, t)) return n.zone;
+        } else {
+            stack[top++] = n.left;
+            stack[top++] = n.right;
+        }
+    }
+    return -1;
+}
+
+bool KeepOutZones::intersectSegment(const double* p0, const double* p1, std::size_t count,
+                                    double& t, int& zone) const {
+    double a[3], b[3];
+    toPoint3(p0, count, a);
+    toPoint3(p1, count, b);
+    if (root == kNull) return false;
+    const double d[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    double best = 2.0;
+    int bestZone = kNull;
+    // The rebuild limit keeps the height (and so the stack depth) far below 128
+    int stack[128];
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+        const Node& n = nodes[stack[--top]];
+        double t0 = 0.0, t1 = std::min(best, 1.0);
+        bool hit = true;
+        for (int i = 0; i < 3 && hit; ++i) hit = clipSlab(a[i], d[i], n.lo[i], n.hi[i], t0, t1);
+        if (!hit) continue;
+        if (n.left == kNull) {
+            double entry;
+            if (intersectZone(zones[n.zone], a, b, entry) && entry < best) {
+                best = entry;
+                bestZone = n.zone;
+            }
+        } else {
+            stack[top++] = n.left;
+            stack[top++] = n.right;
+        }
+    }
+    if (bestZone == kNull) return false;
+    t = best;
+    zone = bestZone;
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef KEEP_OUT_ZONES_H
+#define KEEP_OUT_ZONES_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Set of forbidden regions in stage space (X, Y, Z = the first three axes; missing axes are 0).
+// Zones are closed: touching a zone's surface counts as entering it.
+// The zones' bounding boxes are kept in a dynamic AABB tree, so point and segment queries
+// visit O(log n) zones instead of all of them. Adding or removing a zone inserts or removes
+// one leaf; the tree is rebuilt from scratch only when those edits have unbalanced it.
+// Not thread-safe: edit the set while no query is running.
+class KeepOutZones {
+public:
+    enum class Shape {
+        Box,      // axis-aligned box
+        Cylinder, // vertical cylinder (axis along Z)
+        Polygon   // simple XY polygon extruded along Z (may be non-convex)
+    };
+private:
+    struct Zone {
+        Shape shape;
+        double lo[3], hi[3];        // bounding box (for a box, the zone itself)
+        double cx, cy, radius;      // cylinder
+        std::vector<double> vertices; // polygon, x/y pairs
+        int leaf;                   // tree node, -1 for a free slot
+    };
+    struct Node {
+        double lo[3], hi[3];
+        int parent, left, right;    // left == -1 for a leaf
+        int zone;                   // leaf only
+        int height;                 // 0 for a leaf
+    };
+    static constexpr int kNull = -1;
+
+    std::vector<Zone> zones;    // indexed by zone id
+    std::vector<int> freeZones; // removed zone ids available for reuse
+    std::vector<Node> nodes;
+    int freeNodes;              // free list threaded through Node::parent
+    int root;
+    std::size_t zoneCount;
+
+    int allocateNode();
+    void releaseNode(int node);
+    int addZone(Zone zone);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    void refitUpwards(int node);
+    int buildRange(int* leaves, int count);
+    // Earliest t in [0, 1] at which p0 + t * (p1 - p0) is inside the zone; false if never
+    static bool intersectZone(const Zone& zone, const double* p0, const double* p1, double& t);
+public:
+    KeepOutZones();
+    // Each add returns the new zone's id, or -1 (nothing added) for a degenerate or non-finite zone
+    int addBox(const double minCorner[3], const double maxCorner[3]);
+    int addCylinder(double cx, double cy, double radius, double zMin, double zMax);
+    // xy holds x/y pairs of at least three vertices
+    int addPolygon(const std::vector<double>& xy, double zMin, double zMax);
+    // Remove a zone; its id may be reused by a later add. Returns false for an unknown id.
+    bool removeZone(int id);
+    void clear();
+    std::size_t size() const { return zoneCount; }
+    // Load zones from a text file, replacing the current set; returns false and keeps the
+    // current set on I/O or parse error. One zone per line, ids assigned in file order,
+    // blank lines and '#' comments ignored:
+    //   box      xmin ymin zmin xmax ymax zmax
+    //   cylinder cx cy radius zmin zmax
+    //   polygon  zmin zmax x1 y1 x2 y2 x3 y3 ...
+    bool loadFromFile(const std::string& path);
+    // Rebuild a balanced tree from the current zones (top-down median split)
+    void rebuild();
+    // Height of the tree (0 for one zone, -1 when empty)
+    int treeHeight() const;
+    // Id of a zone containing the point (count coordinates), or -1
+    int findZone(const double* point, std::size_t count) const;
+    // First zone hit by the segment from p0 to p1 (count coordinates each). Returns false if the
+    // segment is clear; otherwise t receives the entry parameter in [0, 1] and zone the zone id.
+    bool intersectSegment(const double* p0, const double* p1, std::size_t count,
+                          double& t, int& zone) const;
+};
+
+#endif // KEEP_OUT_ZONES_H
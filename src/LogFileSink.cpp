@@ -0,0 +1,134 @@
+#include "LogFileSink.h"
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+std::string segmentPath(const std::string& prefix, unsigned index) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), ".%06u.log", index);
+    return prefix + suffix;
+}
+
+} // namespace
+
+LogFileSink::LogFileSink(const std::string& pathPrefix, std::size_t segmentBytes, std::size_t syncEveryBytes)
+    : prefix(pathPrefix), segmentBytes(segmentBytes), syncEveryBytes(syncEveryBytes),
+      fd(-1), mapping(nullptr), used(0), syncedUpTo(0), segmentIndex(0), syncs(0) {
+    if (this->segmentBytes < 64) this->segmentBytes = 64;
+    openSegment(0);
+}
+
+LogFileSink::~LogFileSink() {
+    std::lock_guard<std::mutex> lock(mtx);
+    closeSegment();
+}
+
+bool LogFileSink::openSegment(unsigned index) {
+    // Never overwrite an earlier run: O_EXCL fails on an existing segment, so step past it
+    std::string newPath;
+    int newFd;
+    for (;;) {
+        newPath = segmentPath(prefix, index);
+        newFd = ::open(newPath.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (newFd >= 0) break;
+        if (errno != EEXIST || index == UINT_MAX) return false;
+        ++index;
+    }
+    // Reserve the blocks up front: stores into a sparse mapping raise SIGBUS when the disk
+    // fills, whereas a failed allocation here is an ordinary error
+#if defined(__linux__)
+    int rc = ::posix_fallocate(newFd, 0, static_cast<off_t>(segmentBytes));
+#else
+    int rc = ::ftruncate(newFd, static_cast<off_t>(segmentBytes)) == 0 ? 0 : errno;
+#endif
+    if (rc != 0) {
+        ::close(newFd);
+        ::unlink(newPath.c_str());
+        return false;
+    }
+    void* addr = ::mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, newFd, 0);
+    if (addr == MAP_FAILED) {
+        // Same as a failed allocation: do not leave a full-size empty segment behind
+        ::close(newFd);
+        ::unlink(newPath.c_str());
+        return false;
+    }
+    fd = newFd;
+    mapping = static_cast<char*>(addr);
+    used = 0;
+    syncedUpTo = 0;
+    segmentIndex = index;
+    path = newPath;
+    return true;
+}
+
+void LogFileSink::syncRange() {
+    if (!mapping || used == syncedUpTo) return;
+    // msync needs a page-aligned start address
+    std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t start = syncedUpTo - syncedUpTo % page;
+    ::msync(mapping + start, used - start, MS_SYNC);
+    syncedUpTo = used;
+    ++syncs;
+}
+
+void LogFileSink::closeSegment() {
+    if (!mapping) return;
+    syncRange();
+    ::munmap(mapping, segmentBytes);
+    // Drop the preallocated but unused tail so the file holds only records
+    // (if this fails the zero-filled tail stays and readers stop at the first NUL)
+    int rc = ::ftruncate(fd, static_cast<off_t>(used));
+    (void)rc;
+    ::close(fd);
+    mapping = nullptr;
+    fd = -1;
+}
+
+bool LogFileSink::isOpen() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mapping != nullptr;
+}
+
+bool LogFileSink::append(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!mapping) return false;
+    std::size_t length = message.size();
+    if (length + 1 > segmentBytes) length = segmentBytes - 1;
+    if (used + length + 1 > segmentBytes) {
+        unsigned next = segmentIndex + 1;
+        closeSegment();
+        if (!openSegment(next)) return false;
+    }
+    std::memcpy(mapping + used, message.data(), length);
+    mapping[used + length] = '\n';
+    used += length + 1;
+    if (used - syncedUpTo >= syncEveryBytes) syncRange();
+    return true;
+}
+
+void LogFileSink::sync() {
+    std::lock_guard<std::mutex> lock(mtx);
+    syncRange();
+}
+
+std::string LogFileSink::currentPath() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return path;
+}
+
+unsigned LogFileSink::currentSegment() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return segmentIndex;
+}
+
+std::size_t LogFileSink::syncCount() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return syncs;
+}
@@ -0,0 +1,54 @@
+#ifndef LOG_FILE_SINK_H
+#define LOG_FILE_SINK_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+// Append-only log file sink backed by memory-mapped segment files (POSIX).
+// Each segment "<prefix>.<NNNNNN>.log" is preallocated to segmentBytes and mapped; records are
+// copied into the mapping as text lines, so appends cost no write syscall. On Linux the blocks
+// are reserved with posix_fallocate, so a full disk fails the open or rotation (append returns
+// false) instead of faulting a later store into the mapping. When a segment is
+// full the sink rotates to the next unused index; segments of earlier runs are never reused.
+// msync runs every syncEveryBytes of appended data, on rotation and on close; the unused tail
+// of a closed segment is truncated away.
+class LogFileSink {
+private:
+    std::string prefix;
+    std::size_t segmentBytes;
+    std::size_t syncEveryBytes;
+    std::mutex mtx;
+    int fd;
+    char* mapping;
+    std::size_t used;        // bytes written into the current segment
+    std::size_t syncedUpTo;  // bytes of the current segment covered by the last msync
+    unsigned segmentIndex;
+    std::size_t syncs;
+    std::string path;
+
+    // Create and map the first segment at or after index that does not exist yet
+    bool openSegment(unsigned index);
+    void closeSegment();
+    void syncRange();
+public:
+    LogFileSink(const std::string& pathPrefix, std::size_t segmentBytes = 16 * 1024 * 1024,
+                std::size_t syncEveryBytes = 1024 * 1024);
+    ~LogFileSink();
+    LogFileSink(const LogFileSink&) = delete;
+    LogFileSink& operator=(const LogFileSink&) = delete;
+    // Whether a segment is currently mapped (false if the file could not be created)
+    bool isOpen();
+    // Append one record (message plus newline); returns false if no segment could be mapped
+    bool append(const std::string& message);
+    // Force an msync of everything appended so far
+    void sync();
+    // Path of the segment currently being written
+    std::string currentPath();
+    // Index of the segment currently being written (first segment is the lowest unused index)
+    unsigned currentSegment();
+    // Number of msync calls issued so far
+    std::size_t syncCount();
+};
+
+#endif // LOG_FILE_SINK_H
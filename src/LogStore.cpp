@@ -0,0 +1,72 @@
+#include "LogStore.h"
+#include <cstring>
+
+LogStore::LogStore(std::size_t maxEntries, std::size_t maxBytes)
+    : first(0), count(0), tail(0), bytes(0), evicted(0), truncated(0) {
+    if (maxEntries < 1) maxEntries = 1;
+    if (maxBytes < 1) maxBytes = 1;
+    arena.resize(maxBytes);
+    entries.resize(maxEntries);
+}
+
+void LogStore::evictOldest() {
+    bytes -= entries[first].length;
+    first = (first + 1 == entries.size()) ? 0 : first + 1;
+    --count;
+    ++evicted;
+}
+
+void LogStore::append(const char* data, std::size_t length) {
+    const std::size_t cap = arena.size();
+    if (length > cap) {
+        length = cap;
+        ++truncated;
+    }
+    if (count == entries.size()) evictOldest();
+    // Find a contiguous free span of `length` bytes, evicting oldest entries until one exists.
+    // Free space is [tail, head) circularly; a message never wraps, so the arena end may be skipped.
+    // tail == head is ambiguous (empty or full), so it is resolved by the retained byte count.
+    std::size_t offset;
+    for (;;) {
+        if (bytes == 0) {
+            // Nothing but empty messages (if any) is retained: the whole arena is free. Rebase
+            // them to the start so the oldest offset stays at or before the new message.
+            for (std::size_t i = 0; i < count; ++i) entries[(first + i) % entries.size()].offset = 0;
+            offset = 0;
+            break;
+        }
+        std::size_t head = entries[first].offset;
+        if (tail > head) {
+            if (length <= cap - tail) { offset = tail; break; }
+            if (length <= head) { offset = 0; break; }
+        } else if (tail < head && length <= head - tail) {
+            offset = tail;
+            break;
+        }
+        evictOldest();
+    }
+    if (length > 0) std::memcpy(arena.data() + offset, data, length);
+    std::size_t slot = (first + count) % entries.size();
+    entries[slot].offset = static_cast<std::uint32_t>(offset);
+    entries[slot].length = static_cast<std::uint32_t>(length);
+    ++count;
+    bytes += length;
+    tail = offset + length;
+}
+
+std::vector<std::string> LogStore::snapshot() const {
+    std::vector<std::string> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Entry& e = entries[(first + i) % entries.size()];
+        out.emplace_back(arena.data() + e.offset, e.length);
+    }
+    return out;
+}
+
+void LogStore::clear() {
+    first = 0;
+    count = 0;
+    tail = 0;
+    bytes = 0;
+}
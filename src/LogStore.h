@@ -0,0 +1,50 @@
+#ifndef LOG_STORE_H
+#define LOG_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bounded message store: message bytes live in one preallocated byte ring (arena) and an
+// index ring records where each message starts. When either the entry or the byte budget
+// is exhausted the oldest messages are overwritten and counted as evicted.
+// Not thread-safe; Logger serializes access.
+class LogStore {
+private:
+    struct Entry {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+    std::vector<char> arena;
+    std::vector<Entry> entries;
+    std::size_t first;   // index ring position of the oldest entry
+    std::size_t count;   // number of retained entries
+    std::size_t tail;    // arena offset where the next message is written
+    std::size_t bytes;   // bytes held by retained entries
+    std::size_t evicted; // entries overwritten to make room
+    std::size_t truncated; // messages cut down to fit the arena
+
+    void evictOldest();
+public:
+    LogStore(std::size_t maxEntries, std::size_t maxBytes);
+    // Store a message, evicting the oldest ones as needed (never allocates)
+    void append(const char* data, std::size_t length);
+    // Copy out the retained messages, oldest first
+    std::vector<std::string> snapshot() const;
+    // Drop all retained messages (eviction counters are kept)
+    void clear();
+    // Number of retained messages
+    std::size_t size() const { return count; }
+    // Bytes used by retained message text
+    std::size_t bytesUsed() const { return bytes; }
+    // Configured limits
+    std::size_t maxEntries() const { return entries.size(); }
+    std::size_t maxBytes() const { return arena.size(); }
+    // Number of messages overwritten since construction
+    std::size_t evictedCount() const { return evicted; }
+    // Number of messages longer than the arena that were truncated
+    std::size_t truncatedCount() const { return truncated; }
+};
+
+#endif // LOG_STORE_H
@@ -1,19 +1,187 @@
 #include "Logger.h"
+#include "LogFileSink.h"
+#include "MpscRing.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
-// Define the static storage for log messages
-std::vector<std::string> Logger::messages;
+// Background writer: drains the queue into Logger storage and writes one console batch per pass
+class Logger::AsyncBackend {
+private:
+    static constexpr std::size_t kMaxBatch = 256;
+    MpscRing<std::string> queue; // slots keep their string capacity between uses
+    std::atomic<bool> running;
+    std::atomic<std::size_t> written;  // queue position up to which messages are stored and printed
+    std::atomic<std::size_t>& dropped; // owner's counter of messages rejected by a full queue
+    std::mutex waitMtx;
+    std::condition_variable wakeCv;   // wakes the drain thread early (flush/stop)
+    std::condition_variable drainedCv; // signals flush() waiters after each pass
+    std::thread worker;
+
+    void run(Logger& owner) {
+        std::vector<std::string> batch;
+        batch.reserve(kMaxBatch);
+        std::string out;
+        for (;;) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            batch.clear();
+            queue.popBatch(kMaxBatch, [&batch](const std::string& msg) { batch.push_back(msg); });
+            if (!batch.empty()) {
+                out.clear();
+                for (const auto& msg : batch) {
+                    out += msg;
+                    out += '\n';
+                }
+                {
+                    std::lock_guard<std::mutex> lock(owner.storeMtx);
+                    for (const auto& msg : batch) owner.store.append(msg.data(), msg.size());
+                }
+                owner.writeToSink(batch.data(), batch.size());
+                std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+                std::cout.flush();
+                written.store(queue.dequeued(), std::memory_order_release);
+            }
+            {
+                std::unique_lock<std::mutex> lock(waitMtx);
+                drainedCv.notify_all();
+                if (batch.size() == kMaxBatch) continue;
+                if (stopping && queue.dequeued() == queue.enqueued()) return;
+                wakeCv.wait_for(lock, std::chrono::milliseconds(2));
+            }
+        }
+    }
+public:
+    AsyncBackend(std::size_t capacity, Logger& owner)
+        : queue(capacity), running(true), written(0), dropped(owner.asyncDropped) {
+        worker = std::thread([this, &owner] { run(owner); });
+    }
+
+    ~AsyncBackend() {
+        running.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(waitMtx);
+            wakeCv.notify_one();
+        }
+        worker.join();
+    }
+
+    void push(const std::string& message) {
+        if (!queue.tryPush(message)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void flush() {
+        std::size_t target = queue.enqueued();
+        std::unique_lock<std::mutex> lock(waitMtx);
+        while (written.load(std::memory_order_acquire) < target) {
+            wakeCv.notify_one();
+            drainedCv.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+};
+
+Logger::Logger(std::size_t maxEntries, std::size_t maxBytes) : store(maxEntries, maxBytes) {}
+
+Logger::~Logger() {
+    disableAsync();
+}
+
+void Logger::storeMessage(const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lock(storeMtx);
+        store.append(message.data(), message.size());
+    }
+    writeToSink(&message, 1);
+}
+
+void Logger::writeToSink(const std::string* messages, std::size_t count) {
+    // Unlocked check keeps the no-sink path cheap; the pointer is re-read under the lock
+    if (!fileSink.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(sinkMtx);
+    LogFileSink* sink = fileSink.load(std::memory_order_relaxed);
+    if (!sink) return;
+    for (std::size_t i = 0; i < count; ++i) sink->append(messages[i]);
+}
 
 void Logger::log(const std::string& message) {
-    messages.push_back(message);
+    AsyncBackend* backend = asyncBackend.load(std::memory_order_acquire);
+    if (backend) {
+        backend->push(message);
+        return;
+    }
+    storeMessage(message);
     // Also print to console (could be directed to a file or GUI in real system)
     std::cout << message << std::endl;
 }
 
-const std::vector<std::string>& Logger::getLogs() const {
-    return messages;
+void Logger::log(LogLevel level, const std::string& message) {
+    if (!isEnabled(level)) return;
+    log(message);
+}
+
+void Logger::setLevel(LogLevel level) {
+    minLevel.store(level, std::memory_order_relaxed);
+}
+
+LogLevel Logger::getLevel() const {
+    return minLevel.load(std::memory_order_relaxed);
+}
+
+std::vector<std::string> Logger::getLogs() const {
+    AsyncBackend* backend = asyncBackend.load(std::memory_order_acquire);
+    if (backend) backend->flush();
+    std::lock_guard<std::mutex> lock(storeMtx);
+    return store.snapshot();
 }
 
 void Logger::clear() {
-    messages.clear();
+    AsyncBackend* backend = asyncBackend.load(std::memory_order_acquire);
+    if (backend) backend->flush();
+    std::lock_guard<std::mutex> lock(storeMtx);
+    store.clear();
+}
+
+std::size_t Logger::evictedCount() const {
+    std::lock_guard<std::mutex> lock(storeMtx);
+    return store.evictedCount();
+}
+
+std::size_t Logger::bytesRetained() const {
+    std::lock_guard<std::mutex> lock(storeMtx);
+    return store.bytesUsed();
+}
+
+void Logger::setFileSink(LogFileSink* sink) {
+    flush();
+    // Waits out any batch still writing to the old sink
+    std::lock_guard<std::mutex> lock(sinkMtx);
+    fileSink.store(sink, std::memory_order_release);
+}
+
+void Logger::enableAsync(std::size_t queueCapacity) {
+    if (asyncBackend.load(std::memory_order_acquire)) return;
+    asyncBackend.store(new AsyncBackend(queueCapacity, *this), std::memory_order_release);
+}
+
+void Logger::disableAsync() {
+    AsyncBackend* backend = asyncBackend.exchange(nullptr, std::memory_order_acq_rel);
+    // Destructor drains the remaining messages before joining the drain thread
+    delete backend;
+}
+
+bool Logger::isAsync() const {
+    return asyncBackend.load(std::memory_order_acquire) != nullptr;
+}
+
+void Logger::flush() {
+    AsyncBackend* backend = asyncBackend.load(std::memory_order_acquire);
+    if (backend) backend->flush();
+}
+
+std::size_t Logger::droppedCount() const {
+    return asyncDropped.load(std::memory_order_relaxed);
 }
@@ -1,21 +1,99 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
+#include <cstddef>
+#include <mutex>
 #include <string>
 #include <vector>
+#include "LogStore.h"
+
+class LogFileSink;
+
+// Message severity, ordered from most to least verbose
+enum class LogLevel : int { Debug = 0, Info = 1, Warning = 2, Error = 3, None = 4 };
+
+// Build-time threshold: LOG_* statements below this level compile to nothing.
+// Set with -DLOGGER_COMPILE_LEVEL=<0..4> (see LogLevel values).
+#ifndef LOGGER_COMPILE_LEVEL
+#define LOGGER_COMPILE_LEVEL 0
+#endif
 
 // Logger for recording system events and states
 class Logger {
+public:
+    // Default retention limits for the per-instance message store
+    static constexpr std::size_t kDefaultMaxEntries = 8192;
+    static constexpr std::size_t kDefaultMaxBytes = 512 * 1024;
 private:
-    static std::vector<std::string> messages;
+    class AsyncBackend;
+    LogStore store;                 // bounded per-instance retention
+    mutable std::mutex storeMtx;    // guards store (the async drain thread appends to it)
+    std::atomic<LogLevel> minLevel{LogLevel::Debug};
+    std::atomic<AsyncBackend*> asyncBackend{nullptr};
+    std::atomic<std::size_t> asyncDropped{0};
+    std::atomic<LogFileSink*> fileSink{nullptr}; // written under sinkMtx
+    std::mutex sinkMtx;             // held while a writer uses the sink, so setFileSink can retire it
+
+    void writeToSink(const std::string* messages, std::size_t count);
+
+    void storeMessage(const std::string& message);
 public:
-    Logger() = default;
-    // Log a message (store it and output to console)
+    // Retain at most maxEntries messages and maxBytes of message text (oldest overwritten first)
+    explicit Logger(std::size_t maxEntries = kDefaultMaxEntries, std::size_t maxBytes = kDefaultMaxBytes);
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+    // Log a message (store it and output to console).
+    // In async mode the message is queued and written by the drain thread instead.
     void log(const std::string& message);
-    // Retrieve all logged messages
-    const std::vector<std::string>& getLogs() const;
+    // Log a message at the given severity (dropped if below the runtime threshold)
+    void log(LogLevel level, const std::string& message);
+    // Set the runtime threshold; messages below it are discarded
+    void setLevel(LogLevel level);
+    // Get the runtime threshold
+    LogLevel getLevel() const;
+    // Check whether a message at this level would be recorded (one relaxed load)
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= static_cast<int>(minLevel.load(std::memory_order_relaxed));
+    }
+    // Retrieve a snapshot of all logged messages (pending async messages are drained first)
+    std::vector<std::string> getLogs() const;
     // Clear all logged messages
     void clear();
+    // Number of retained messages overwritten because a retention limit was reached
+    std::size_t evictedCount() const;
+    // Bytes of message text currently retained
+    std::size_t bytesRetained() const;
+    // Also append every stored message to a file sink (nullptr detaches). The sink must
+    // outlive the logger or be detached first; in async mode the drain thread writes to it.
+    // Once this returns no thread is still writing to the previous sink, so it may be destroyed.
+    void setFileSink(LogFileSink* sink);
+    // Switch to async mode: log() pushes into a bounded MPSC ring buffer of queueCapacity
+    // slots (rounded up to a power of two) and a background thread writes them in batches.
+    // Mode switches must not race with concurrent log() calls.
+    void enableAsync(std::size_t queueCapacity = 4096);
+    // Drain any pending messages, stop the background thread and return to synchronous mode
+    void disableAsync();
+    // Query whether async mode is active
+    bool isAsync() const;
+    // Block until every message queued so far has been stored and written out
+    void flush();
+    // Number of messages dropped because the async queue was full
+    std::size_t droppedCount() const;
 };
 
+// Level-filtered logging. Statements below LOGGER_COMPILE_LEVEL are discarded at compile time;
+// otherwise the message expression is only evaluated if the level passes the runtime threshold.
+#define LOG_AT(logger, level, ...)                                                       \
+    do {                                                                                 \
+        if constexpr (static_cast<int>(level) >= LOGGER_COMPILE_LEVEL) {                 \
+            if ((logger).isEnabled(level)) (logger).log((level), __VA_ARGS__);           \
+        }                                                                                \
+    } while (0)
+#define LOG_DEBUG(logger, ...) LOG_AT(logger, LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(logger, ...)  LOG_AT(logger, LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(logger, ...)  LOG_AT(logger, LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(logger, ...) LOG_AT(logger, LogLevel::Error, __VA_ARGS__)
+
 #endif // LOGGER_H
@@ -3,21 +3,34 @@
 #include "TriggerHandler.h"
 #include "SafetyMonitor.h"
 #include "Logger.h"
+#include "EventLog.h"
+#include <algorithm>
 #include <string>
 
 MotionController::MotionController(CalibrationManager& calib, TriggerHandler& trigger,
                                    SafetyMonitor& safety, Logger& log, int numAxes)
     : axesCount(numAxes), initialized(false), currentState(State::IDLE),
-      calibManager(calib), triggerHandler(trigger), safetyMonitor(safety), logger(log) {
+      lastCalibrationVersion(0), calibManager(calib), triggerHandler(trigger), safetyMonitor(safety), logger(log),
+      eventLog(nullptr), completionRunning(false) {
     if (axesCount < 1) axesCount = 1;
     axes.resize(axesCount);
+    stagePositions.resize(axesCount);
+}
+
+MotionController::~MotionController() {
+    {
+        std::lock_guard<std::mutex> lock(completionMtx);
+        completionRunning = false;
+    }
+    completionCv.notify_all();
+    if (completionWorker.joinable()) completionWorker.join();
 }
 
 const CML::Error* MotionController::initialize() {
     // Open the network connection
     const CML::Error* err = network.Open();
     if (err != CML::SUCCESS) {
-        logger.log("Error: Failed to open network");
+        LOG_ERROR(logger, "Error: Failed to open network");
         currentState = State::ERROR;
         return err;
     }
@@ -25,35 +38,35 @@ const CML::Error* MotionController::initialize() {
     CML::AmpSettings settings;
     err = axes[0].Init(network, -1, settings);
     if (err != CML::SUCCESS) {
-        logger.log("Error: Failed to initialize primary axis");
+        LOG_ERROR(logger, "Error: Failed to initialize primary axis");
         currentState = State::ERROR;
         return err;
     }
-    logger.log("Primary axis initialized");
+    LOG_INFO(logger, "Primary axis initialized");
     // Initialize additional axes (if any)
     for (int i = 1; i < axesCount; ++i) {
         err = axes[i].InitSubAxis(axes[0], i+1, settings);
         if (err != CML::SUCCESS) {
-            logger.log(std::string("Error: Failed to initialize axis ") + std::to_string(i+1));
+            LOG_ERROR(logger, std::string("Error: Failed to initialize axis ") + std::to_string(i+1));
             currentState = State::ERROR;
             return err;
         }
-        logger.log(std::string("Axis ") + std::to_string(i+1) + " initialized");
+        LOG_INFO(logger, std::string("Axis ") + std::to_string(i+1) + " initialized");
     }
     initialized = true;
     currentState = State::IDLE;
-    logger.log("MotionController initialization complete");
+    LOG_INFO(logger, "MotionController initialization complete");
     return CML::SUCCESS;
 }
 const CML::Error* MotionController::homeAll() {
   if (!initialized) {
-      logger.log("Home failed: MotionController not initialized");
+      LOG_ERROR(logger, "Home failed: MotionController not initialized");
       currentState = State::ERROR;
       static CML::Error errNotInit(-110, "MotionController not initialized");
       return &errNotInit;
   }
 
-  logger.log("Starting homing sequence for all axes...");
+  LOG_INFO(logger, "Starting homing sequence for all axes...");
 
   CML::HomeConfig homeCfg;
   homeCfg.method = CML::CHM_NONE; // Adjust to CHM_INDEX_POS or others if needed
@@ -64,7 +77,7 @@ const CML::Error* MotionController::homeAll() {
   for (int i = 0; i < axesCount; ++i) {
       const CML::Error* err = axes[i].GoHome(homeCfg);
       if (err != CML::SUCCESS) {
-          logger.log("Error: Failed to home axis " + std::to_string(i+1));
+          LOG_ERROR(logger, "Error: Failed to home axis " + std::to_string(i+1));
           currentState = State::ERROR;
           return err;
       }
@@ -72,75 +85,162 @@ const CML::Error* MotionController::homeAll() {
 
   const CML::Error* waitErr = CML::Amp::WaitMoveDone(axes.data(), axesCount, 20000);
   if (waitErr != CML::SUCCESS) {
-      logger.log("Error: Timeout or failure during homing wait");
+      LOG_ERROR(logger, "Error: Timeout or failure during homing wait");
       currentState = State::ERROR;
       return waitErr;
   }
 
   currentState = State::IDLE;
-  logger.log("Homing complete on all axes.");
+  LOG_INFO(logger, "Homing complete on all axes.");
   return CML::SUCCESS;
 }
 const CML::Error* MotionController::moveTo(const std::vector<double>& targetPositions, bool calibrated) {
     if (!initialized) {
-        logger.log("Move failed: MotionController not initialized");
+        LOG_ERROR(logger, "Move failed: MotionController not initialized");
         currentState = State::ERROR;
         static CML::Error errNotInit(-100, "MotionController not initialized");
         return &errNotInit;
     }
-    if (safetyMonitor.isEmergencyStop()) {
-        logger.log("Move aborted: Emergency Stop is active");
+    static CML::Error errEStop(-101, "Emergency stop active");
+    // A stop engaged from another thread while the axes are being commanded ends the batch; the
+    // generation comes from the same load as the check, so nothing can slip in between
+    std::uint64_t stopGeneration = 0;
+    if (safetyMonitor.isEmergencyStop(stopGeneration)) {
+        LOG_WARN(logger, "Move aborted: Emergency Stop is active");
         currentState = State::EMERGENCY_STOP;
-        static CML::Error errEStop(-101, "Emergency stop active");
         return &errEStop;
     }
     if ((int)targetPositions.size() != axesCount) {
-        logger.log("Move failed: Target position vector size mismatch");
+        LOG_ERROR(logger, "Move failed: Target position vector size mismatch");
         currentState = State::ERROR;
         static CML::Error errSize(-102, "Incorrect number of target positions");
         return &errSize;
     }
     // Apply calibration if coordinates are in world frame
-    std::vector<double> stagePositions = targetPositions;
+    // Stage targets go into the preallocated buffer, so a move does not allocate
     if (calibrated) {
-        stagePositions = calibManager.applyCalibration(targetPositions);
-        if (axesCount >= 2) {
-            logger.log("Applied calibration transform: [" +
-                       std::to_string(targetPositions[0]) + "," + std::to_string(targetPositions[1]) + "] -> [" +
-                       std::to_string(stagePositions[0]) + "," + std::to_string(stagePositions[1]) + "]");
+        calibManager.applyCalibration(targetPositions.data(), stagePositions.data(), axesCount,
+                                      &lastCalibrationVersion);
+        if (eventLog) {
+            if (axesCount >= 2) {
+                const double values[4] = {targetPositions[0], targetPositions[1],
+                                          stagePositions[0], stagePositions[1]};
+                eventLog->record(EventId::CalibrationApplied, -1, values, 4);
+            } else {
+                eventLog->record(EventId::CalibrationApplied);
+            }
+        } else if (axesCount >= 2) {
+            LOG_DEBUG(logger, "Applied calibration transform: [" +
+                      std::to_string(targetPositions[0]) + "," + std::to_string(targetPositions[1]) + "] -> [" +
+                      std::to_string(stagePositions[0]) + "," + std::to_string(stagePositions[1]) + "] (calibration v" +
+                      std::to_string(lastCalibrationVersion) + ")");
         } else {
-            logger.log("Applied calibration transform to target positions");
+            LOG_DEBUG(logger, "Applied calibration transform to target positions (calibration v" +
+                      std::to_string(lastCalibrationVersion) + ")");
         }
+    } else {
+        std::copy(targetPositions.begin(), targetPositions.end(), stagePositions.begin());
     }
     // Check safety limits for each axis
     if (!safetyMonitor.checkPosition(stagePositions)) {
-        logger.log("Move denied: Target position out of safety bounds");
+        // checkPosition also fails on an engaged e-stop; a stop that landed since the check
+        // above is reported as such, not as a bounds violation
+        if (safetyMonitor.stoppedSince(stopGeneration)) {
+            LOG_WARN(logger, "Move aborted: Emergency Stop engaged during the safety check");
+            currentState = State::EMERGENCY_STOP;
+            return &errEStop;
+        }
+        LOG_WARN(logger, "Move denied: Target position out of safety bounds");
         currentState = State::ERROR;
         static CML::Error errBounds(-103, "Target position out of safety bounds");
         return &errBounds;
     }
     // Execute move on all axes
-    logger.log("Moving to positions: [" +
-        (axesCount > 0 ? std::to_string(stagePositions[0]) : "") +
-        (axesCount > 1 ? "," + std::to_string(stagePositions[1]) : "") +
-        (axesCount > 2 ? "," + std::to_string(stagePositions[2]) : "") +
-        (axesCount > 3 ? "," + std::to_string(stagePositions[3]) : "") + "]");
+    if (eventLog) {
+        eventLog->record(EventId::MoveStarted, -1, stagePositions.data(),
+                         std::min<std::size_t>(stagePositions.size(), EventRecord::kMaxValues));
+    } else {
+        LOG_DEBUG(logger, "Moving to positions: [" +
+            (axesCount > 0 ? std::to_string(stagePositions[0]) : "") +
+            (axesCount > 1 ? "," + std::to_string(stagePositions[1]) : "") +
+            (axesCount > 2 ? "," + std::to_string(stagePositions[2]) : "") +
+            (axesCount > 3 ? "," + std::to_string(stagePositions[3]) : "") + "]");
+    }
     currentState = State::MOVING;
     for (int i = 0; i < axesCount; ++i) {
+        if (safetyMonitor.stoppedSince(stopGeneration)) {
+            LOG_WARN(logger, "Move aborted: Emergency Stop engaged before axis " + std::to_string(i+1));
+            currentState = State::EMERGENCY_STOP;
+            return &errEStop;
+        }
         const CML::Error* moveErr = axes[i].MoveAbs(stagePositions[i]);
         if (moveErr != CML::SUCCESS) {
-            logger.log(std::string("Error moving axis ") + std::to_string(i+1) +
-                       " to position " + std::to_string(stagePositions[i]));
+            if (eventLog) {
+                eventLog->record(EventId::AxisMoveFailed, i, &stagePositions[i], 1);
+            } else {
+                LOG_ERROR(logger, std::string("Error moving axis ") + std::to_string(i+1) +
+                          " to position " + std::to_string(stagePositions[i]));
+            }
             currentState = State::ERROR;
             return moveErr;
         }
     }
     // In a real system, we might wait for motion completion or check status here
     currentState = State::IDLE;
-    logger.log("Move completed");
+    if (eventLog) {
+        // The calibration version (if any) travels with the completion record
+        if (calibrated) {
+            const double version = static_cast<double>(lastCalibrationVersion);
+            eventLog->record(EventId::MoveCompleted, -1, &version, 1);
+        } else {
+            eventLog->record(EventId::MoveCompleted);
+        }
+    } else {
+        LOG_INFO(logger, "Move completed");
+    }
     return CML::SUCCESS;
 }
 
+const CML::Error* MotionController::waitMoveDone() {
+    return CML::Amp::WaitMoveDone(axes.data(), axesCount, kMoveDoneTimeoutMs);
+}
+
+void MotionController::whenMoveDone(std::function<void(const CML::Error*)> callback) {
+    {
+        std::lock_guard<std::mutex> lock(completionMtx);
+        pendingCompletions.push_back(std::move(callback));
+        if (!completionWorker.joinable()) {
+            completionRunning = true;
+            completionWorker = std::thread([this]() { runCompletions(); });
+        }
+    }
+    completionCv.notify_one();
+}
+
+void MotionController::runCompletions() {
+    std::deque<std::function<void(const CML::Error*)>> batch;
+    std::unique_lock<std::mutex> lock(completionMtx);
+    for (;;) {
+        completionCv.wait(lock, [this] { return !completionRunning || !pendingCompletions.empty(); });
+        // Queued callbacks are still served on shutdown, so no awaiting coroutine is stranded
+        if (pendingCompletions.empty()) break;
+        batch.swap(pendingCompletions);
+        lock.unlock();
+        const CML::Error* err = waitMoveDone();
+        for (auto& callback : batch) callback(err);
+        batch.clear();
+        lock.lock();
+    }
+}
+
+std::uint64_t MotionController::getLastCalibrationVersion() const {
+    return lastCalibrationVersion;
+}
+
+void MotionController::setEventLog(EventLog* log) {
+    eventLog = log;
+}
+
 void MotionController::emergencyStop() {
     // Stop all axes immediately
     for (int i = 0; i < axesCount; ++i) {
@@ -149,7 +249,7 @@ void MotionController::emergencyStop() {
     // Engage safety lockout and update state
     safetyMonitor.triggerEStop();
     currentState = State::EMERGENCY_STOP;
-    logger.log("Emergency Stop engaged! All motion halted.");
+    LOG_WARN(logger, "Emergency Stop engaged! All motion halted.");
 }
 
 MotionController::State MotionController::getState() const {
@@ -162,3 +262,15 @@ double MotionController::getAxisPosition(int axisIndex) const {
     }
     return axes[axisIndex].GetPosition();
 }
+
+int MotionController::getAxesCount() const {
+    return axesCount;
+}
+
+std::size_t MotionController::readPositions(double* positions, std::size_t maxCount) const {
+    std::size_t count = std::min(maxCount, static_cast<std::size_t>(axesCount));
+    for (std::size_t i = 0; i < count; ++i) {
+        positions[i] = axes[i].GetPosition();
+    }
+    return count;
+}
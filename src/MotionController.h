@@ -1,14 +1,23 @@
 #ifndef MOTION_CONTROLLER_H
 #define MOTION_CONTROLLER_H
 
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "cml.h"
+#include "Executor.h"
 
 // Forward declarations of component classes
 class CalibrationManager;
 class TriggerHandler;
 class SafetyMonitor;
 class Logger;
+class EventLog;
 
 // High-level motion controller coordinating motors, calibration, triggers, and safety
 class MotionController {
@@ -21,26 +30,109 @@ private:
     int axesCount;
     bool initialized;
     State currentState;
+    std::vector<double> stagePositions; // scratch buffer for calibrated targets (reused by moveTo)
+    std::uint64_t lastCalibrationVersion; // calibration version used by the last calibrated move (0 = none)
     // References to external components
     CalibrationManager& calibManager;
     TriggerHandler& triggerHandler;
     SafetyMonitor& safetyMonitor;
     Logger& logger;
+    // Optional binary event log for per-move events (nullptr = text messages via logger)
+    EventLog* eventLog;
+    // Completion thread for whenMoveDone, started on first use. One WaitMoveDone serves every
+    // callback queued before it started, since they all wait on the same axes.
+    std::mutex completionMtx;
+    std::condition_variable completionCv;
+    std::deque<std::function<void(const CML::Error*)>> pendingCompletions;
+    bool completionRunning;
+    std::thread completionWorker;
+
+    void runCompletions();
 public:
+    // Timeout for a commanded move to finish (waitMoveDone / whenMoveDone)
+    static constexpr int kMoveDoneTimeoutMs = 20000;
+
     MotionController(CalibrationManager& calib, TriggerHandler& trigger,
                      SafetyMonitor& safety, Logger& log, int numAxes = 1);
+    // Waits for queued whenMoveDone callbacks to run
+    ~MotionController();
+    MotionController(const MotionController&) = delete;
+    MotionController& operator=(const MotionController&) = delete;
     // Initialize network and all axes
     const CML::Error* initialize();
     // Move to target positions (size of vector must equal number of axes).
     // If calibrated==true, interpret targetPositions in world coordinates and apply calibration.
     const CML::Error* homeAll();
     const CML::Error* moveTo(const std::vector<double>& targetPositions, bool calibrated = true);
+    // Block until the axes have finished their commanded moves (CML::Amp::WaitMoveDone)
+    const CML::Error* waitMoveDone();
+    // Run callback with the waitMoveDone result on the completion thread, once the moves
+    // commanded so far have finished. Never blocks the caller.
+    void whenMoveDone(std::function<void(const CML::Error*)> callback);
+    // Awaitable for coroutines: `const CML::Error* err = co_await ctrl.moveAsync(pos);`.
+    // Commands the move on the executor thread, then resumes the coroutine through its executor
+    // once the move has completed, letting other recipes run in between (see Executor.h).
+    // targetPositions is referenced, not copied: it must outlive the co_await (a temporary in
+    // the co_await expression does).
+    class MoveAwaiter;
+    MoveAwaiter moveAsync(const std::vector<double>& targetPositions, bool calibrated = true);
+    // Route per-move events (calibration, move start/completion) to a binary event log
+    // instead of formatted Logger messages; pass nullptr to restore text logging
+    void setEventLog(EventLog* log);
     // Perform an emergency stop on all axes and mark system as halted
     void emergencyStop();
+    // Calibration version used by the most recent calibrated move (0 if none yet)
+    std::uint64_t getLastCalibrationVersion() const;
     // Get current controller state
     State getState() const;
     // Get the current position of a specified axis
     double getAxisPosition(int axisIndex) const;
+    // Number of controlled axes
+    int getAxesCount() const;
+    // Copy the current position of the first maxCount axes into positions (no allocation);
+    // returns the number written
+    std::size_t readPositions(double* positions, std::size_t maxCount) const;
 };
 
+class MotionController::MoveAwaiter {
+private:
+    MotionController& controller;
+    const std::vector<double>& targets;
+    bool calibrated;
+    const CML::Error* result;
+public:
+    MoveAwaiter(MotionController& controller, const std::vector<double>& targets, bool calibrated)
+        : controller(controller), targets(targets), calibrated(calibrated), result(nullptr) {}
+    bool await_ready() const { return false; }
+    // Commands the move, then resumes through the executor once the axes report the move done
+    // (the wait runs on the controller's completion thread, not on the executor). Without an
+    // executor the wait happens here and the coroutine continues at once (returns false).
+    template <class Handle>
+    bool await_suspend(Handle handle) {
+        result = controller.moveTo(targets, calibrated);
+        Executor* executor = Executor::current();
+        if (!executor) {
+            if (result == CML::SUCCESS) result = controller.waitMoveDone();
+            return false;
+        }
+        if (result != CML::SUCCESS) {
+            executor->post([handle]() mutable { handle.resume(); });
+            return true;
+        }
+        executor->addWork();
+        controller.whenMoveDone([this, executor, handle](const CML::Error* err) mutable {
+            result = err;  // the awaiter lives in the suspended frame until the resumption runs
+            executor->post([handle]() mutable { handle.resume(); });
+            executor->finishWork();
+        });
+        return true;
+    }
+    const CML::Error* await_resume() const { return result; }
+};
+
+inline MotionController::MoveAwaiter MotionController::moveAsync(const std::vector<double>& targetPositions,
+                                                                  bool calibrated) {
+    return MoveAwaiter(*this, targetPositions, calibrated);
+}
+
 #endif // MOTION_CONTROLLER_H
@@ -0,0 +1,87 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded lock-free multi-producer / single-consumer ring buffer (Vyukov-style sequence slots).
+// Producers never block: a push into a full ring fails. Slot values are assigned in place, so a
+// type such as std::string keeps its capacity between uses and a steady-state push does not allocate.
+template <typename T>
+class MpscRing {
+private:
+    struct Slot {
+        std::atomic<std::size_t> seq;
+        T value;
+    };
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> enqueuePos;
+    alignas(64) std::atomic<std::size_t> dequeuePos;
+public:
+    // Capacity is rounded up to a power of two
+    explicit MpscRing(std::size_t capacity) : enqueuePos(0), dequeuePos(0) {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+        for (std::size_t i = 0; i < size; ++i) {
+            slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Producer side (any thread): returns false if the ring is full
+    bool tryPush(const T& value) {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[pos & mask];
+            std::size_t seq = slot->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = value;
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side (one thread at a time): hands up to maxCount ready values, in order, to
+    // consume(const T&) and releases their slots; returns the count
+    template <typename Consume>
+    std::size_t popBatch(std::size_t maxCount, Consume&& consume) {
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+        while (count < maxCount) {
+            Slot& slot = slots[pos & mask];
+            if (slot.seq.load(std::memory_order_acquire) != pos + 1) break;
+            consume(static_cast<const T&>(slot.value));
+            slot.seq.store(pos + mask + 1, std::memory_order_release);
+            ++pos;
+            ++count;
+        }
+        dequeuePos.store(pos, std::memory_order_release);
+        return count;
+    }
+
+    // Positions claimed by producers / released by the consumer so far
+    std::size_t enqueued() const { return enqueuePos.load(std::memory_order_acquire); }
+    std::size_t dequeued() const { return dequeuePos.load(std::memory_order_acquire); }
+    // Approximate number of queued values
+    std::size_t size() const {
+        std::size_t head = dequeued();
+        std::size_t tail = enqueued();
+        return tail > head ? tail - head : 0;
+    }
+    std::size_t capacity() const { return mask + 1; }
+};
+
+#endif // MPSC_RING_H
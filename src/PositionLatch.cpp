@@ -0,0 +1,71 @@
+#include "PositionLatch.h"
+#include "MotionController.h"
+#include "CalibrationManager.h"
+#include <algorithm>
+
+PositionLatch::PositionLatch(MotionController& motion, std::size_t capacity, int triggerId)
+    : motion(motion), calibration(nullptr), latchTrigger(triggerId),
+      axes(static_cast<std::size_t>(motion.getAxesCount())), capacity(std::max<std::size_t>(capacity, 1)),
+      timestamps(this->capacity), positions(this->capacity * axes),
+      head(0), tail(0), overruns(0) {
+    producerBusy.clear();
+}
+
+void PositionLatch::setCalibration(const CalibrationManager* calib) {
+    calibration.store(calib, std::memory_order_release);
+}
+
+void PositionLatch::setTriggerId(int triggerId) {
+    latchTrigger.store(triggerId, std::memory_order_relaxed);
+}
+
+void PositionLatch::onTriggerEdge(int triggerId, bool rising, std::uint64_t timestampNs) {
+    if (rising && triggerId == latchTrigger.load(std::memory_order_relaxed)) {
+        capture(timestampNs);
+    }
+}
+
+bool PositionLatch::capture(std::uint64_t timestampNs) {
+    while (producerBusy.test_and_set(std::memory_order_acquire)) {
+        // Another thread is latching; captures take well under a microsecond
+    }
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == capacity) {
+        producerBusy.clear(std::memory_order_release);
+        overruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    std::size_t slot = t % capacity;
+    double* p = positions.data() + slot * axes;
+    motion.readPositions(p, axes);
+    if (const CalibrationManager* calib = calibration.load(std::memory_order_acquire)) {
+        calib->applyInverseCalibration(p, p, axes);
+    }
+    timestamps[slot] = timestampNs;
+    tail.store(t + 1, std::memory_order_release);
+    producerBusy.clear(std::memory_order_release);
+    return true;
+}
+
+std::size_t PositionLatch::read(std::uint64_t* timestampsOut, double* positionsOut, std::size_t maxCaptures) {
+    std::size_t h = head.load(std::memory_order_relaxed);
+    std::size_t n = std::min(maxCaptures, tail.load(std::memory_order_acquire) - h);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t slot = (h + i) % capacity;
+        if (timestampsOut) timestampsOut[i] = timestamps[slot];
+        if (positionsOut) {
+            std::copy(positions.data() + slot * axes, positions.data() + (slot + 1) * axes,
+                      positionsOut + i * axes);
+        }
+    }
+    head.store(h + n, std::memory_order_release);
+    return n;
+}
+
+std::size_t PositionLatch::available() const {
+    return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+}
+
+std::uint64_t PositionLatch::overrunCount() const {
+    return overruns.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,53 @@
+#ifndef POSITION_LATCH_H
+#define POSITION_LATCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "TriggerHandler.h"
+
+class MotionController;
+class CalibrationManager;
+
+// Latches every axis position when a trigger fires (fly-by capture). Attach it with
+// TriggerHandler::setListener; on each rising edge of the latch trigger the positions are read
+// into a preallocated ring, optionally converted back to world coordinates. A capture is
+// constant-time and allocation-free. Captures are read in bulk by one consumer thread; if the
+// consumer falls behind, new captures are dropped and counted.
+class PositionLatch : public TriggerListener {
+private:
+    MotionController& motion;
+    std::atomic<const CalibrationManager*> calibration; // non-null: store world coordinates
+    std::atomic<int> latchTrigger;
+    std::size_t axes;
+    std::size_t capacity;
+    std::vector<std::uint64_t> timestamps;  // capacity entries
+    std::vector<double> positions;          // capacity * axes entries
+    std::atomic_flag producerBusy;          // serializes captures from different threads
+    alignas(64) std::atomic<std::size_t> head;  // next capture to read (consumer)
+    alignas(64) std::atomic<std::size_t> tail;  // next capture to write (producer)
+    std::atomic<std::uint64_t> overruns;
+public:
+    PositionLatch(MotionController& motion, std::size_t capacity = 1024, int triggerId = TRIG_CAPTURE);
+    PositionLatch(const PositionLatch&) = delete;
+    PositionLatch& operator=(const PositionLatch&) = delete;
+    // Convert latched positions to world coordinates with the inverse calibration (nullptr = stage)
+    void setCalibration(const CalibrationManager* calib);
+    // Trigger id whose rising edges latch positions
+    void setTriggerId(int triggerId);
+    // TriggerListener: latch on rising edges of the latch trigger
+    void onTriggerEdge(int triggerId, bool rising, std::uint64_t timestampNs) override;
+    // Latch the current positions now, stamped with timestampNs; returns false if the ring is full
+    bool capture(std::uint64_t timestampNs);
+    // Move up to maxCaptures of the oldest captures out of the ring: timestampsOut[i] and
+    // positionsOut[i * axesCount() + axis]. Either output may be nullptr. Returns the count.
+    std::size_t read(std::uint64_t* timestampsOut, double* positionsOut, std::size_t maxCaptures);
+    // Captures waiting to be read
+    std::size_t available() const;
+    std::size_t axesCount() const { return axes; }
+    // Captures dropped because the ring was full
+    std::uint64_t overrunCount() const;
+};
+
+#endif // POSITION_LATCH_H
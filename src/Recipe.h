@@ -0,0 +1,69 @@
+#ifndef RECIPE_H
+#define RECIPE_H
+
+#include "Executor.h"
+
+// Coroutine task type for inspection recipes. Needs C++20 coroutines; build with
+// INSPECTION_ENABLE_COROUTINES=ON. Without them this header declares nothing, and the
+// awaiters (TriggerHandler::when, MotionController::moveAsync) remain usable from other
+// coroutine types or with Executor callbacks.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define INSPECTION_HAS_COROUTINES 1
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+// A fire-and-forget recipe coroutine:
+//     Recipe inspect(MotionController& ctrl, TriggerHandler& triggers) {
+//         co_await ctrl.moveAsync({10.0, 20.0});
+//         co_await triggers.when(TRIG_CAPTURE);
+//     }
+//     inspect(ctrl, triggers).spawn(executor);
+// The recipe starts when the executor runs it and its frame is freed when it finishes.
+class Recipe {
+public:
+    struct promise_type {
+        Executor* executor = nullptr;
+        Recipe get_return_object() {
+            return Recipe(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        // Destroys the frame and releases the executor's outstanding work
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                Executor* executor = handle.promise().executor;
+                handle.destroy();
+                if (executor) executor->finishWork();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Recipe(Recipe&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Recipe(const Recipe&) = delete;
+    Recipe& operator=(const Recipe&) = delete;
+    Recipe& operator=(Recipe&&) = delete;
+    ~Recipe() {
+        if (handle) handle.destroy();
+    }
+
+    // Hand the recipe to executor; executor.run() returns only after it has finished
+    void spawn(Executor& executor) && {
+        std::coroutine_handle<promise_type> h = std::exchange(handle, nullptr);
+        h.promise().executor = &executor;
+        executor.addWork();
+        executor.post([h]() { h.resume(); });
+    }
+private:
+    explicit Recipe(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+#endif // coroutines
+
+#endif // RECIPE_H
@@ -1,7 +1,90 @@
 #include "SafetyMonitor.h"
+#include "KeepOutZones.h"
+#include <algorithm>
+#include <chrono>
 
-SafetyMonitor::SafetyMonitor(int axesCount) : emergencyStopEngaged(false) {
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// SIMD compares for the batch bounds check; the widest instruction set enabled at build time is used
+#if defined(__AVX__)
+struct SimdOps {
+    using V = __m256d;
+    static constexpr std::size_t width = 4;
+    static V set1(double v) { return _mm256_set1_pd(v); }
+    static V load(const double* p) { return _mm256_loadu_pd(p); }
+    // Lanes with lo <= v <= hi (false for NaN), one bit per lane
+    static unsigned inRange(V v, V lo, V hi) {
+        return static_cast<unsigned>(_mm256_movemask_pd(
+            _mm256_and_pd(_mm256_cmp_pd(v, lo, _CMP_GE_OQ), _mm256_cmp_pd(v, hi, _CMP_LE_OQ))));
+    }
+};
+#define SAFETY_HAVE_SIMD 1
+#elif defined(__SSE2__)
+struct SimdOps {
+    using V = __m128d;
+    static constexpr std::size_t width = 2;
+    static V set1(double v) { return _mm_set1_pd(v); }
+    static V load(const double* p) { return _mm_loadu_pd(p); }
+    static unsigned inRange(V v, V lo, V hi) {
+        return static_cast<unsigned>(_mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(v, lo), _mm_cmple_pd(v, hi))));
+    }
+};
+#define SAFETY_HAVE_SIMD 1
+#endif
+
+// Out-of-bounds bits for n <= 64 points; axis a of point i is at first[a * axisStride + i]
+std::uint64_t boundsFailBits(const double* first, std::size_t axisStride, const double* lo, const double* hi,
+                             std::size_t axes, std::size_t n) {
+    std::uint64_t fail = 0;
+    for (std::size_t a = 0; a < axes; ++a) {
+        const double* values = first + a * axisStride;
+        std::size_t i = 0;
+#ifdef SAFETY_HAVE_SIMD
+        const SimdOps::V vLo = SimdOps::set1(lo[a]);
+        const SimdOps::V vHi = SimdOps::set1(hi[a]);
+        constexpr unsigned allLanes = (1u << SimdOps::width) - 1;
+        for (; i + SimdOps::width <= n; i += SimdOps::width) {
+            const unsigned outside = ~SimdOps::inRange(SimdOps::load(values + i), vLo, vHi) & allLanes;
+            fail |= static_cast<std::uint64_t>(outside) << i;
+        }
+#endif
+        for (; i < n; ++i) {
+            if (!(values[i] >= lo[a] && values[i] <= hi[a])) fail |= std::uint64_t(1) << i;
+        }
+    }
+    return fail;
+}
+
+bool validLimits(const SafetyMonitor::KinematicLimits& limits) {
+    return limits.velocity > 0.0 && limits.acceleration > 0.0 &&
+           limits.deceleration > 0.0 && limits.jerk > 0.0;
+}
+
+std::size_t lowestSetBit(std::uint64_t bits) {
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_ctzll(bits));
+#else
+    std::size_t index = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+} // namespace
+
+SafetyMonitor::SafetyMonitor(int axesCount)
+    : stopState(0), stopTimestampNs(0), stopStampGeneration(0), keepOutZones(nullptr) {
     if (axesCount < 1) axesCount = 1;
+    axisLimits.resize(axesCount);
     minBounds.resize(axesCount);
     maxBounds.resize(axesCount);
     // Default bounds: very wide range (user can tighten via setAxisBounds)
@@ -17,29 +100,203 @@ void SafetyMonitor::setAxisBounds(int axisIndex, double minPos, double maxPos) {
     maxBounds[axisIndex] = maxPos;
 }
 
+bool SafetyMonitor::setAxisLimits(int axisIndex, const KinematicLimits& limits) {
+    if (axisIndex < 0 || axisIndex >= (int)axisLimits.size() || !validLimits(limits)) return false;
+    axisLimits[axisIndex] = limits;
+    return true;
+}
+
+bool SafetyMonitor::setVectorLimits(const KinematicLimits& limits) {
+    if (!validLimits(limits)) return false;
+    vectorLimits = limits;
+    return true;
+}
+
+SafetyMonitor::KinematicLimits SafetyMonitor::getAxisLimits(int axisIndex) const {
+    if (axisIndex < 0 || axisIndex >= (int)axisLimits.size()) return KinematicLimits();
+    return axisLimits[axisIndex];
+}
+
+bool SafetyMonitor::limitMoveProfile(KinematicLimits& profile, LimitMode mode) const {
+    double* values[4] = {&profile.velocity, &profile.acceleration, &profile.deceleration, &profile.jerk};
+    const double limits[4] = {vectorLimits.velocity, vectorLimits.acceleration,
+                              vectorLimits.deceleration, vectorLimits.jerk};
+    for (int i = 0; i < 4; ++i) {
+        if (!(*values[i] > 0.0)) return false;
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (*values[i] > limits[i]) {
+            if (mode == LimitMode::Reject) return false;
+            *values[i] = limits[i];
+        }
+    }
+    return true;
+}
+
+void SafetyMonitor::setKeepOutZones(const KeepOutZones* zones) {
+    keepOutZones = zones;
+}
+
 bool SafetyMonitor::checkPosition(const std::vector<double>& positions) const {
-    if (emergencyStopEngaged) {
+    return checkPosition(positions.data(), positions.size());
+}
+
+bool SafetyMonitor::checkPosition(const double* positions, std::size_t count) const {
+    if (isEmergencyStop()) {
         // If emergency stop is active, treat any move as unsafe
         return false;
     }
-    int n = positions.size();
-    int maxAxis = (int)minBounds.size();
-    for (int i = 0; i < n && i < maxAxis; ++i) {
-        if (positions[i] < minBounds[i] || positions[i] > maxBounds[i]) {
+    const std::size_t checked = std::min(count, minBounds.size());
+    for (std::size_t i = 0; i < checked; ++i) {
+        if (!(positions[i] >= minBounds[i] && positions[i] <= maxBounds[i])) {
             return false;
         }
     }
+    if (keepOutZones && keepOutZones->findZone(positions, count) >= 0) {
+        return false;
+    }
     return true;
 }
 
-void SafetyMonitor::triggerEStop() {
-    emergencyStopEngaged = true;
+std::size_t SafetyMonitor::checkPositionsBatch(const double* positions, std::size_t count, std::size_t axes,
+                                               std::uint64_t* failMask) const {
+    if (isEmergencyStop()) {
+        if (failMask) {
+            for (std::size_t base = 0; base < count; base += 64) {
+                const std::size_t n = std::min<std::size_t>(64, count - base);
+                failMask[base / 64] = (n == 64) ? ~std::uint64_t(0) : ((std::uint64_t(1) << n) - 1);
+            }
+        }
+        return 0;
+    }
+    const std::size_t checked = std::min(axes, minBounds.size());
+    const std::size_t zoneAxes = std::min<std::size_t>(axes, 3);
+    std::size_t firstFail = count;
+    // 64 points per mask word
+    for (std::size_t base = 0; base < count; base += 64) {
+        const std::size_t n = std::min<std::size_t>(64, count - base);
+        std::uint64_t fail = boundsFailBits(positions + base, count, minBounds.data(), maxBounds.data(),
+                                            checked, n);
+        if (keepOutZones) {
+            for (std::size_t i = 0; i < n; ++i) {
+                if (fail & (std::uint64_t(1) << i)) continue;
+                double point[3];
+                for (std::size_t a = 0; a < zoneAxes; ++a) point[a] = positions[a * count + base + i];
+                if (keepOutZones->findZone(point, zoneAxes) >= 0) fail |= std::uint64_t(1) << i;
+            }
+        }
+        if (failMask) failMask[base / 64] = fail;
+        if (fail && firstFail == count) {
+            firstFail = base + lowestSetBit(fail);
+            if (!failMask) break;
+        }
+    }
+    return firstFail;
+}
+
+bool SafetyMonitor::checkPath(const double* points, std::size_t pointCount, std::size_t axes,
+                              PathViolation* violation) const {
+    PathViolation found;
+    if (isEmergencyStop()) {
+        found.kind = PathViolation::Kind::EmergencyStop;
+    } else if (pointCount > 0 && axes > 0) {
+        const std::size_t checked = std::min(axes, minBounds.size());
+        // A lone point is a zero-length segment
+        const std::size_t segments = (pointCount > 1) ? pointCount - 1 : 1;
+        for (std::size_t k = 0; k < segments && found.kind == PathViolation::Kind::None; ++k) {
+            const double* p0 = points + k * axes;
+            const double* p1 = (pointCount > 1) ? p0 + axes : p0;
+            // The bounds are a box: the segment is inside it up to the smallest exit parameter
+            double firstT = 2.0;
+            int firstAxis = -1;
+            for (std::size_t i = 0; i < checked; ++i) {
+                const double lo = minBounds[i];
+                const double hi = maxBounds[i];
+                double t;
+                if (!(p0[i] >= lo && p0[i] <= hi)) {
+                    t = 0.0; // starts outside (or non-finite)
+                } else if (!(p1[i] >= lo && p1[i] <= hi)) {
+                    if (p1[i] > hi) t = (hi - p0[i]) / (p1[i] - p0[i]);
+                    else if (p1[i] < lo) t = (lo - p0[i]) / (p1[i] - p0[i]);
+                    else t = 1.0; // non-finite end point
+                } else {
+                    continue;
+                }
+                if (t < firstT) {
+                    firstT = t;
+                    firstAxis = static_cast<int>(i);
+                }
+            }
+            double zoneT;
+            int zone;
+            if (keepOutZones && keepOutZones->intersectSegment(p0, p1, axes, zoneT, zone) && zoneT < firstT) {
+                found.kind = PathViolation::Kind::KeepOutZone;
+                found.segment = k;
+                found.t = zoneT;
+                found.zone = zone;
+            } else if (firstAxis >= 0) {
+                found.kind = PathViolation::Kind::AxisBounds;
+                found.segment = k;
+                found.t = firstT;
+                found.axis = firstAxis;
+            }
+        }
+    }
+    if (violation) *violation = found;
+    return found.kind == PathViolation::Kind::None;
+}
+
+bool SafetyMonitor::checkPath(const std::vector<std::vector<double>>& points, PathViolation* violation) const {
+    // Flatten to the contiguous layout; points shorter than the first are padded with zeros
+    const std::size_t axes = points.empty() ? 0 : points.front().size();
+    std::vector<double> flat(points.size() * axes, 0.0);
+    for (std::size_t k = 0; k < points.size(); ++k) {
+        std::copy_n(points[k].begin(), std::min(axes, points[k].size()), flat.begin() + k * axes);
+    }
+    return checkPath(flat.data(), points.size(), axes, violation);
+}
+
+void SafetyMonitor::triggerEStop(StopReason reason) {
+    if (reason == StopReason::None) reason = StopReason::Unspecified;
+    const std::uint64_t now = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    std::uint64_t state = stopState.load(std::memory_order_relaxed);
+    std::uint64_t engaged;
+    do {
+        if (state & 1u) return; // already engaged: keep the first reason latched
+        const std::uint64_t generation = (state >> kGenerationShift) + 1;
+        engaged = (generation << kGenerationShift) |
+                  (static_cast<std::uint64_t>(reason) << kReasonShift) | 1u;
+    } while (!stopState.compare_exchange_weak(state, engaged, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed));
+    // Only the winning trigger gets here, once per generation
+    stopTimestampNs.store(now, std::memory_order_relaxed);
+    stopStampGeneration.store(engaged >> kGenerationShift, std::memory_order_release);
 }
 
 void SafetyMonitor::clearEStop() {
-    emergencyStopEngaged = false;
+    // The generation is kept; the reason bits are dropped with the engaged bit
+    std::uint64_t state = stopState.load(std::memory_order_relaxed);
+    do {
+        if (!(state & 1u)) return;
+    } while (!stopState.compare_exchange_weak(state, (state >> kGenerationShift) << kGenerationShift,
+                                              std::memory_order_acq_rel, std::memory_order_relaxed));
+}
+
+SafetyMonitor::StopReason SafetyMonitor::getStopReason() const {
+    const std::uint64_t state = stopState.load(std::memory_order_acquire);
+    if (!(state & 1u)) return StopReason::None;
+    return static_cast<StopReason>((state >> kReasonShift) & 0x7fu);
 }
 
-bool SafetyMonitor::isEmergencyStop() const {
-    return emergencyStopEngaged;
+std::uint64_t SafetyMonitor::getStopTimestampNs() const {
+    const std::uint64_t state = stopState.load(std::memory_order_acquire);
+    if (!(state & 1u)) return 0;
+    // The timestamp counts only if it was published for this generation and not replaced by a
+    // later one while it was read
+    const std::uint64_t generation = state >> kGenerationShift;
+    if (stopStampGeneration.load(std::memory_order_acquire) != generation) return 0;
+    const std::uint64_t stamp = stopTimestampNs.load(std::memory_order_acquire);
+    if (stopStampGeneration.load(std::memory_order_relaxed) != generation) return 0;
+    return stamp;
 }
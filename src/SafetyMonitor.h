@@ -1,26 +1,131 @@
 #ifndef SAFETY_MONITOR_H
 #define SAFETY_MONITOR_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <vector>
 
-// Monitors and enforces safety limits (position bounds, emergency stop state)
+class KeepOutZones;
+
+// Monitors and enforces safety limits (position bounds, emergency stop state).
+// The e-stop may be triggered from any thread (e.g. a watchdog) while motion threads check it.
 class SafetyMonitor {
+public:
+    // Why the emergency stop was engaged (latched until clearEStop)
+    enum class StopReason : std::uint32_t {
+        None = 0,        // not engaged
+        Unspecified = 1,
+        Operator = 2,    // manual stop (button, UI)
+        Watchdog = 3,    // a supervision deadline was missed
+        LimitViolation = 4,
+        DriveFault = 5,
+        External = 6     // e.g. a safety PLC or interlock input
+    };
+    // First point of a path that breaks a limit. Segment k runs from point k to point k + 1 and
+    // the path is at points[k] + t * (points[k + 1] - points[k]) when the limit is crossed.
+    struct PathViolation {
+        enum class Kind { None, EmergencyStop, AxisBounds, KeepOutZone };
+        Kind kind = Kind::None;
+        std::size_t segment = 0;
+        double t = 0.0;
+        int axis = -1; // axis whose bounds are crossed (AxisBounds only)
+        int zone = -1; // id of the zone entered (KeepOutZone only)
+    };
+    // Kinematic envelope, in the units of CML::Linkage::SetMoveLimits (position units per second,
+    // per second squared, per second cubed). Infinity means unlimited.
+    struct KinematicLimits {
+        double velocity = std::numeric_limits<double>::infinity();
+        double acceleration = std::numeric_limits<double>::infinity();
+        double deceleration = std::numeric_limits<double>::infinity();
+        double jerk = std::numeric_limits<double>::infinity();
+    };
+    // How a limit breach is handled: drop the command, or scale it down to the envelope
+    enum class LimitMode { Reject, Clamp };
 private:
     std::vector<double> minBounds;
     std::vector<double> maxBounds;
-    bool emergencyStopEngaged;
+    // Bit 0: e-stop engaged; bits 1..7: StopReason of the engaging trigger; bits 8..63: stop
+    // generation (number of times it was engaged). One word, so trigger / clear are a single CAS
+    // and the hot path reads everything with one acquire load.
+    static constexpr unsigned kReasonShift = 1;
+    static constexpr unsigned kGenerationShift = 8;
+    std::atomic<std::uint64_t> stopState;
+    // Engage time of stop generation stopStampGeneration, published by the thread whose CAS won
+    std::atomic<std::uint64_t> stopTimestampNs;
+    std::atomic<std::uint64_t> stopStampGeneration;
+    const KeepOutZones* keepOutZones; // optional forbidden regions (not owned)
+    std::vector<KinematicLimits> axisLimits;
+    KinematicLimits vectorLimits; // along the path of a coordinated move
 public:
     SafetyMonitor(int axesCount = 1);
     // Define allowed position range for a specific axis
     void setAxisBounds(int axisIndex, double minPos, double maxPos);
-    // Check if given positions are within bounds (returns false if any axis out of range or if E-stop engaged)
+    // Per-axis kinematic limits; returns false (limits unchanged) for a bad axis or a limit that
+    // is not positive (NaN or <= 0)
+    bool setAxisLimits(int axisIndex, const KinematicLimits& limits);
+    // Limits on the path speed / acceleration / jerk of coordinated (multi-axis) motion
+    bool setVectorLimits(const KinematicLimits& limits);
+    // Limits of one axis (unlimited for an axis outside the configured range)
+    KinematicLimits getAxisLimits(int axisIndex) const;
+    const KinematicLimits& getVectorLimits() const { return vectorLimits; }
+    // Check a coordinated move profile (the values passed to CML::Linkage::SetMoveLimits) against
+    // the vector limits. Reject: returns false if any value exceeds its limit or is not positive.
+    // Clamp: lowers each value to its limit and returns false only for a non-positive value.
+    bool limitMoveProfile(KinematicLimits& profile, LimitMode mode) const;
+    // Also reject positions and paths inside any of these zones (nullptr detaches). The zones must
+    // outlive the monitor or be detached first, and must not be edited while checks are running.
+    void setKeepOutZones(const KeepOutZones* zones);
+    // Check if given positions are within bounds (returns false if any axis out of range, inside a
+    // keep-out zone or if E-stop engaged). Non-finite coordinates are out of range.
     bool checkPosition(const std::vector<double>& positions) const;
-    // Trigger an emergency stop condition (engage E-stop)
-    void triggerEStop();
+    bool checkPosition(const double* positions, std::size_t count) const;
+    // Check count points at once. positions is SoA and contiguous: axis a of point i is at
+    // positions[a * count + i]. Bounds are compared with SIMD (AVX or SSE2 when enabled at build
+    // time); keep-out zones, if attached, are then queried for the points that passed.
+    // Returns the index of the first failing point, or count if every point passes. If failMask
+    // is given it must hold (count + 63) / 64 words and receives one set bit per failing point
+    // (bit i % 64 of word i / 64); without it the scan stops at the first failure.
+    std::size_t checkPositionsBatch(const double* positions, std::size_t count, std::size_t axes,
+                                    std::uint64_t* failMask = nullptr) const;
+    // Trigger an emergency stop condition (engage E-stop). Safe from any thread; if the stop is
+    // already engaged the original reason and timestamp stay latched.
+    void triggerEStop(StopReason reason = StopReason::Unspecified);
     // Clear the emergency stop condition (for recovery procedures)
     void clearEStop();
-    // Query whether emergency stop is currently engaged
-    bool isEmergencyStop() const;
+    // Query whether emergency stop is currently engaged (one acquire load)
+    bool isEmergencyStop() const {
+        return (stopState.load(std::memory_order_acquire) & 1u) != 0;
+    }
+    // As above, and also return the stop generation from the same load. A long-running move
+    // samples both at the start and calls stoppedSince() between steps.
+    bool isEmergencyStop(std::uint64_t& generation) const {
+        std::uint64_t state = stopState.load(std::memory_order_acquire);
+        generation = state >> kGenerationShift;
+        return (state & 1u) != 0;
+    }
+    // Number of times the e-stop has been engaged
+    std::uint64_t getStopGeneration() const {
+        return stopState.load(std::memory_order_acquire) >> kGenerationShift;
+    }
+    // Whether the e-stop is engaged now or was engaged after generation was sampled (one load)
+    bool stoppedSince(std::uint64_t generation) const {
+        std::uint64_t state = stopState.load(std::memory_order_acquire);
+        return (state & 1u) != 0 || (state >> kGenerationShift) != generation;
+    }
+    // Reason latched by the trigger that engaged the current stop (None when not engaged)
+    StopReason getStopReason() const;
+    // steady_clock time (ns since its epoch) at which the current stop was engaged. 0 when not
+    // engaged, or in the instant between the engaging CAS and the publication of its timestamp.
+    std::uint64_t getStopTimestampNs() const;
+    // Validate a straight-line polyline of pointCount points (axes doubles each, contiguous) against
+    // the limits. Each segment is checked analytically, so a path that leaves the bounds or clips a
+    // keep-out zone between two valid points is caught without sampling. Returns false and fills violation (if given)
+    // with the first crossing along the path; a single point is checked as segment 0, t = 0.
+    bool checkPath(const double* points, std::size_t pointCount, std::size_t axes,
+                   PathViolation* violation = nullptr) const;
+    bool checkPath(const std::vector<std::vector<double>>& points, PathViolation* violation = nullptr) const;
 };
 
 #endif // SAFETY_MONITOR_H
@@ -0,0 +1,72 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel(Handler handler, Clock::duration tick, std::size_t slotCount)
+    : tick(std::max<Clock::duration>(tick, Clock::duration(1))), handler(std::move(handler)),
+      origin(Clock::now()), slots(std::max<std::size_t>(slotCount, 1)),
+      processedTick(0), pending(0), running(true) {
+    worker = std::thread([this]() { run(); });
+}
+
+TimerWheel::~TimerWheel() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+std::uint64_t TimerWheel::tickOf(Clock::time_point t) const {
+    if (t <= origin) return 0;
+    return static_cast<std::uint64_t>((t - origin) / tick);
+}
+
+void TimerWheel::schedule(Clock::duration delay, int id, std::uint64_t tag) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        // Round up so a timer never fires before its delay has fully elapsed
+        std::uint64_t dueTick = tickOf(Clock::now() + delay) + 1;
+        dueTick = std::max(dueTick, processedTick + 1);
+        slots[dueTick % slots.size()].push_back(Entry{dueTick, id, tag});
+        ++pending;
+    }
+    cv.notify_one();
+}
+
+std::size_t TimerWheel::pendingCount() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return pending;
+}
+
+void TimerWheel::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (running) {
+        if (pending == 0) {
+            // Idle time needs no slot walk: catch up before sleeping, not after waking, so a
+            // late wake-up cannot carry processedTick past a timer scheduled during the wait
+            processedTick = std::max(processedTick, tickOf(Clock::now()));
+            cv.wait(lock, [this] { return !running || pending > 0; });
+            continue;
+        }
+        cv.wait_until(lock, origin + tick * static_cast<Clock::rep>(processedTick + 1));
+        std::uint64_t now = tickOf(Clock::now());
+        due.clear();
+        // Serve every slot passed since the last pass (at most one full turn of the wheel)
+        std::uint64_t first = processedTick + 1;
+        std::uint64_t last = std::min(now, processedTick + slots.size());
+        for (std::uint64_t t = first; t <= last && pending > 0; ++t) {
+            std::vector<Entry>& slot = slots[t % slots.size()];
+            auto keep = std::partition(slot.begin(), slot.end(),
+                                       [now](const Entry& e) { return e.dueTick > now; });
+            due.insert(due.end(), keep, slot.end());
+            pending -= static_cast<std::size_t>(slot.end() - keep);
+            slot.erase(keep, slot.end());
+        }
+        if (now > processedTick) processedTick = now;
+        if (due.empty()) continue;
+        lock.unlock();
+        for (const Entry& e : due) handler(e.id, e.tag);
+        lock.lock();
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Hashed timer wheel served by one background thread. Timers carry an (id, tag) pair and fire
+// through a single handler, so scheduling does not allocate once the slots have grown. There is
+// no cancel: owners bump their tag and ignore stale expiries. Timers fire at most one tick late.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Handler = std::function<void(int id, std::uint64_t tag)>;
+private:
+    struct Entry {
+        std::uint64_t dueTick;
+        int id;
+        std::uint64_t tag;
+    };
+    const Clock::duration tick;
+    const Handler handler;
+    const Clock::time_point origin;
+    std::vector<std::vector<Entry>> slots;
+    std::vector<Entry> due;   // scratch for expired timers (worker only)
+    std::uint64_t processedTick; // all slots up to this tick have been served
+    std::size_t pending;
+    bool running;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread worker;
+
+    std::uint64_t tickOf(Clock::time_point t) const;
+    void run();
+public:
+    // Handler runs on the wheel thread, never with the wheel locked
+    TimerWheel(Handler handler, Clock::duration tick = std::chrono::microseconds(250), std::size_t slotCount = 512);
+    ~TimerWheel();
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    // Fire handler(id, tag) once `delay` has elapsed
+    void schedule(Clock::duration delay, int id, std::uint64_t tag);
+    // Timers not yet fired
+    std::size_t pendingCount();
+};
+
+#endif // TIMER_WHEEL_H
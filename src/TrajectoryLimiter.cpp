@@ -0,0 +1,150 @@
+#include "TrajectoryLimiter.h"
+#include <algorithm>
+#include <cmath>
+
+TrajectoryLimiter::TrajectoryLimiter(const SafetyMonitor& safety, std::size_t axes, double period,
+                                     SafetyMonitor::LimitMode mode)
+    : safety(safety), mode(mode), axes(axes),
+      period((period > 0.0 && std::isfinite(period)) ? period : 1e-3), invPeriod(1.0 / this->period),
+      position(axes, 0.0), velocity(axes, 0.0), acceleration(axes, 0.0),
+      pathSpeed(0.0), pathAcceleration(0.0), clamped(0), rejected(0) {
+    constraints.reserve(axes + 1);
+}
+
+void TrajectoryLimiter::reset(const double* start) {
+    std::copy(start, start + axes, position.begin());
+    std::fill(velocity.begin(), velocity.end(), 0.0);
+    std::fill(acceleration.begin(), acceleration.end(), 0.0);
+    pathSpeed = 0.0;
+    pathAcceleration = 0.0;
+}
+
+bool TrajectoryLimiter::applyGroup(double& sLo, double& sHi) const {
+    double lo = sLo, hi = sHi;
+    bool feasible = true;
+    for (const Constraint& c : constraints) {
+        if (c.beta == 0.0) {
+            if (!(c.alpha >= c.lo && c.alpha <= c.hi)) {
+                feasible = false;
+                break;
+            }
+            continue;
+        }
+        double a = (c.lo - c.alpha) / c.beta;
+        double b = (c.hi - c.alpha) / c.beta;
+        if (c.beta < 0.0) std::swap(a, b);
+        lo = std::max(lo, a);
+        hi = std::min(hi, b);
+    }
+    if (feasible && lo <= hi) {
+        sLo = lo;
+        sHi = hi;
+        return true;
+    }
+    // Not reachable along the step: take the s with the smallest worst relative excess.
+    // Each excess is convex and piecewise linear in s, so a ternary search finds the minimum.
+    auto worstExcess = [this](double s) {
+        double worst = 0.0;
+        for (const Constraint& c : constraints) {
+            double v = c.alpha + c.beta * s;
+            if (v > c.hi) worst = std::max(worst, (v - c.hi) / c.hi);
+            else if (v < c.lo) worst = std::max(worst, (c.lo - v) / -c.lo);
+        }
+        return worst;
+    };
+    double a = sLo, b = sHi;
+    for (int i = 0; i < 60; ++i) {
+        double m1 = a + (b - a) / 3.0;
+        double m2 = b - (b - a) / 3.0;
+        if (worstExcess(m1) <= worstExcess(m2)) b = m2;
+        else a = m1;
+    }
+    sLo = sHi = 0.5 * (a + b);
+    return false;
+}
+
+TrajectoryLimiter::Result TrajectoryLimiter::step(const double* command, double* out, SafetyMonitor::LimitMode stepMode) {
+    const SafetyMonitor::KinematicLimits& path = safety.getVectorLimits();
+    const double ip = invPeriod;
+    double dist2 = 0.0;
+    for (std::size_t i = 0; i < axes; ++i) {
+        double d = command[i] - position[i];
+        dist2 += d * d;
+    }
+    if (!std::isfinite(dist2)) {
+        // A non-finite command cannot be scaled into the envelope
+        ++rejected;
+        return Result::Rejected;
+    }
+    const double dist = std::sqrt(dist2);
+    double sLo = 0.0, sHi = 1.0;
+    bool withinEnvelope = true;
+
+    // Velocity: v(s) = s * d / T (always met at s = 0)
+    constraints.clear();
+    for (std::size_t i = 0; i < axes; ++i) {
+        const double limit = safety.getAxisLimits(static_cast<int>(i)).velocity;
+        constraints.push_back({0.0, (command[i] - position[i]) * ip, -limit, limit});
+    }
+    constraints.push_back({0.0, dist * ip, -path.velocity, path.velocity});
+    withinEnvelope = applyGroup(sLo, sHi) && withinEnvelope;
+
+    // Acceleration: a(s) = (v(s) - v) / T. Deceleration applies when a opposes the current
+    // velocity, so the bounds follow sign(v), not the commanded step: a reversal brakes first.
+    constraints.clear();
+    for (std::size_t i = 0; i < axes; ++i) {
+        const SafetyMonitor::KinematicLimits limits = safety.getAxisLimits(static_cast<int>(i));
+        const double v = velocity[i];
+        const double lo = v > 0.0 ? -limits.deceleration : -limits.acceleration;
+        const double hi = v < 0.0 ? limits.deceleration : limits.acceleration;
+        constraints.push_back({-v * ip, (command[i] - position[i]) * ip * ip, lo, hi});
+    }
+    constraints.push_back({-pathSpeed * ip, dist * ip * ip, -path.deceleration, path.acceleration});
+    withinEnvelope = applyGroup(sLo, sHi) && withinEnvelope;
+
+    // Jerk: j(s) = (a(s) - a) / T
+    constraints.clear();
+    for (std::size_t i = 0; i < axes; ++i) {
+        const double limit = safety.getAxisLimits(static_cast<int>(i)).jerk;
+        constraints.push_back({(-velocity[i] * ip - acceleration[i]) * ip,
+                               (command[i] - position[i]) * ip * ip * ip, -limit, limit});
+    }
+    constraints.push_back({(-pathSpeed * ip - pathAcceleration) * ip, dist * ip * ip * ip,
+                           -path.jerk, path.jerk});
+    withinEnvelope = applyGroup(sLo, sHi) && withinEnvelope;
+
+    // Take the longest allowed step
+    const bool full = withinEnvelope && sHi >= 1.0 - 1e-9;
+    if (!full && stepMode == SafetyMonitor::LimitMode::Reject) {
+        ++rejected;
+        return Result::Rejected;
+    }
+    const double s = full ? 1.0 : sHi;
+    for (std::size_t i = 0; i < axes; ++i) {
+        const double d = s * (command[i] - position[i]);
+        const double v = d * ip;
+        acceleration[i] = (v - velocity[i]) * ip;
+        velocity[i] = v;
+        position[i] = full ? command[i] : position[i] + d;
+        if (out) out[i] = position[i];
+    }
+    const double speed = s * dist * ip;
+    pathAcceleration = (speed - pathSpeed) * ip;
+    pathSpeed = speed;
+    if (full) return Result::Accepted;
+    ++clamped;
+    return Result::Clamped;
+}
+
+TrajectoryLimiter::Result TrajectoryLimiter::process(double* point) {
+    return step(point, point, mode);
+}
+
+std::size_t TrajectoryLimiter::validate(const double* points, std::size_t count) {
+    if (count == 0) return 0;
+    reset(points);
+    for (std::size_t k = 1; k < count; ++k) {
+        if (step(points + k * axes, nullptr, SafetyMonitor::LimitMode::Reject) == Result::Rejected) return k;
+    }
+    return count;
+}
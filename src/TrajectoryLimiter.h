@@ -0,0 +1,67 @@
+#ifndef TRAJECTORY_LIMITER_H
+#define TRAJECTORY_LIMITER_H
+
+#include <cstddef>
+#include <vector>
+#include "SafetyMonitor.h"
+
+// Enforces the SafetyMonitor kinematic envelope (per-axis and vector limits) on a stream of
+// trajectory points sampled at a fixed period, e.g. the cyclic position update rate. Velocity,
+// acceleration and jerk are the finite differences of consecutive points. A point costs O(axes)
+// and never allocates, so the limiter can sit on every streamed point.
+// Clamp mode shortens the commanded step: the output stays on the line from the previous point
+// to the command, so the direction of motion is kept and the output trails the command until it
+// catches up. If the envelope cannot be met along that line (e.g. the command reverses faster
+// than the deceleration limit allows), jerk and then acceleration are exceeded as little as
+// possible; velocity limits always hold.
+// Reject mode refuses such a point and keeps the state at the previous point.
+class TrajectoryLimiter {
+public:
+    enum class Result { Accepted, Clamped, Rejected };
+private:
+    // Constraint alpha + beta * s in [lo, hi] on the fraction s of the commanded step
+    struct Constraint {
+        double alpha, beta, lo, hi;
+    };
+    const SafetyMonitor& safety;
+    SafetyMonitor::LimitMode mode;
+    std::size_t axes;
+    double period;
+    double invPeriod;
+    // State after the last output point
+    std::vector<double> position;
+    std::vector<double> velocity;
+    std::vector<double> acceleration;
+    double pathSpeed;
+    double pathAcceleration;
+    std::vector<Constraint> constraints; // scratch, axes + 1 entries
+    std::size_t clamped;
+    std::size_t rejected;
+
+    // Narrow [sLo, sHi] to the constraints of one group. Returns false if the group cannot be met
+    // there; the interval then collapses to the least-violating s.
+    bool applyGroup(double& sLo, double& sHi) const;
+    // Advance towards command; writes the output point to out if given
+    Result step(const double* command, double* out, SafetyMonitor::LimitMode stepMode);
+public:
+    // period: time between points in seconds (an invalid period falls back to 1 ms).
+    // The limiter starts at rest at the origin.
+    TrajectoryLimiter(const SafetyMonitor& safety, std::size_t axes, double period,
+                      SafetyMonitor::LimitMode mode = SafetyMonitor::LimitMode::Clamp);
+    // Restart at rest at the given position (axes values)
+    void reset(const double* start);
+    // Limit the next commanded point (axes values). Clamp mode rewrites it in place; Reject mode
+    // leaves it untouched and returns Rejected if it breaks the envelope.
+    Result process(double* point);
+    // Check a whole trajectory of count points (axes values each, contiguous) in Reject mode,
+    // starting at rest at the first point. Returns the index of the first point that breaks the
+    // envelope, or count. The limiter is left at the last accepted point.
+    std::size_t validate(const double* points, std::size_t count);
+    // Position after the last output point
+    const double* getPosition() const { return position.data(); }
+    // Points changed (or left outside the envelope) by Clamp mode / refused by Reject mode
+    std::size_t clampedCount() const { return clamped; }
+    std::size_t rejectedCount() const { return rejected; }
+};
+
+#endif // TRAJECTORY_LIMITER_H
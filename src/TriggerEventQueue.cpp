@@ -0,0 +1,21 @@
+#include "TriggerEventQueue.h"
+
+TriggerEventQueue::TriggerEventQueue(std::size_t capacity) : ring(capacity), dropped(0) {}
+
+bool TriggerEventQueue::push(const TriggerEvent& event) {
+    if (ring.tryPush(event)) return true;
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+std::size_t TriggerEventQueue::popBatch(TriggerEvent* out, std::size_t maxCount) {
+    return ring.popBatch(maxCount, [out](const TriggerEvent& event) mutable { *out++ = event; });
+}
+
+std::size_t TriggerEventQueue::size() const {
+    return ring.size();
+}
+
+std::uint64_t TriggerEventQueue::droppedCount() const {
+    return dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,40 @@
+#ifndef TRIGGER_EVENT_QUEUE_H
+#define TRIGGER_EVENT_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "MpscRing.h"
+
+// One trigger transition, timestamped when the trigger was set or cleared
+struct TriggerEvent {
+    enum class Edge : std::uint8_t { Rising = 1, Falling = 0 };
+    std::uint64_t timestampNs; // steady_clock time since its epoch
+    std::int32_t triggerId;
+    Edge edge;
+};
+
+// Bounded lock-free multi-producer / single-consumer queue of trigger events (an MpscRing).
+// Producers never block: a push into a full queue is dropped and counted. The consumer drains
+// events in batches.
+class TriggerEventQueue {
+private:
+    MpscRing<TriggerEvent> ring;
+    std::atomic<std::uint64_t> dropped;
+public:
+    // Capacity is rounded up to a power of two
+    explicit TriggerEventQueue(std::size_t capacity = 4096);
+    TriggerEventQueue(const TriggerEventQueue&) = delete;
+    TriggerEventQueue& operator=(const TriggerEventQueue&) = delete;
+    // Producer side (any thread): returns false and counts a drop if the queue is full
+    bool push(const TriggerEvent& event);
+    // Consumer side (one thread at a time): copies up to maxCount events in order; returns the count
+    std::size_t popBatch(TriggerEvent* out, std::size_t maxCount);
+    // Approximate number of queued events
+    std::size_t size() const;
+    std::size_t capacity() const { return ring.capacity(); }
+    // Events rejected because the queue was full
+    std::uint64_t droppedCount() const;
+};
+
+#endif // TRIGGER_EVENT_QUEUE_H
@@ -1,39 +1,486 @@
 #include "TriggerHandler.h"
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
 
-TriggerHandler::TriggerHandler() {
-    // Initialize known triggers to false (inactive)
-    triggerStates[TRIG_START]   = false;
-    triggerStates[TRIG_STOP]    = false;
-    triggerStates[TRIG_CAPTURE] = false;
+namespace {
+
+// now + timeout, saturated at time_point::max() so a huge timeout (e.g. Duration::max())
+// waits indefinitely instead of overflowing into a deadline in the past
+std::chrono::steady_clock::time_point deadlineAfter(TriggerHandler::Duration timeout) {
+    const auto now = std::chrono::steady_clock::now();
+    if (timeout <= TriggerHandler::Duration::zero()) return now;
+    if (timeout >= std::chrono::steady_clock::time_point::max() - now) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    return now + timeout;
+}
+
+} // namespace
+
+TriggerHandler::TriggerHandler()
+    : eventQueue(nullptr), listener(nullptr), fdCount(0), anySparseDebounced(false) {
+    // Initialize all dense triggers (including the known ones) to false (inactive)
+    for (auto& word : denseStates) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    for (auto& word : denseWaited) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    for (auto& count : denseEdgeCounts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    for (auto& word : denseDebounced) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+TriggerHandler::~TriggerHandler() {
+    timers.reset();  // stop the timer thread before the filters it refers to go away
+    for (const FdRegistration& reg : fdRegistrations) {
+        close(reg.readFd);
+        if (reg.writeFd != reg.readFd) close(reg.writeFd);
+    }
+}
+
+void TriggerHandler::recordEdge(int triggerId, bool rising) {
+    if (rising && isDense(triggerId)) {
+        denseEdgeCounts[triggerId].fetch_add(1, std::memory_order_relaxed);
+    }
+    TriggerEventQueue* queue = eventQueue.load(std::memory_order_acquire);
+    TriggerListener* callback = listener.load(std::memory_order_acquire);
+    if (!queue && !callback) return;
+    std::uint64_t timestampNs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    if (queue) {
+        TriggerEvent event;
+        event.timestampNs = timestampNs;
+        event.triggerId = triggerId;
+        event.edge = rising ? TriggerEvent::Edge::Rising : TriggerEvent::Edge::Falling;
+        queue->push(event);
+    }
+    if (callback) {
+        callback->onTriggerEdge(triggerId, rising, timestampNs);
+    }
+}
+
+bool TriggerHandler::readState(int triggerId) {
+    if (isDense(triggerId)) {
+        // seq_cst, not acquire: this is the waiter's half of the handshake with applyState (mark
+        // the id / bump fdCount, then read the state vs. set the state, then read the mark). Only
+        // when all four accesses are seq_cst can both sides not miss each other. On x86 and
+        // AArch64 the load costs the same as an acquire load.
+        std::uint64_t word = denseStates[triggerId / kBitsPerWord].load(std::memory_order_seq_cst);
+        return (word >> (triggerId % kBitsPerWord)) & 1u;
+    }
+    auto it = triggerStates.find(triggerId);
+    return it != triggerStates.end() && it->second;
+}
+
+void TriggerHandler::linkWaiter(int triggerId, WaitNode& node) {
+    WaitNode*& head = waitLists[triggerId];
+    node.prev = nullptr;
+    node.next = head;
+    if (head) head->prev = &node;
+    head = &node;
+    updateWaitedMark(triggerId);
+}
+
+void TriggerHandler::unlinkWaiter(int triggerId, WaitNode& node) {
+    auto it = waitLists.find(triggerId);
+    if (node.prev) node.prev->next = node.next;
+    else it->second = node.next;
+    if (node.next) node.next->prev = node.prev;
+    if (it->second == nullptr) {
+        waitLists.erase(it);
+        updateWaitedMark(triggerId);
+    }
+}
+
+void TriggerHandler::updateWaitedMark(int triggerId) {
+    if (!isDense(triggerId)) return;
+    std::uint64_t bit = std::uint64_t(1) << (triggerId % kBitsPerWord);
+    auto& word = denseWaited[triggerId / kBitsPerWord];
+    if (waitLists.count(triggerId) || callbacks.count(triggerId)) {
+        word.fetch_or(bit, std::memory_order_seq_cst);
+    } else {
+        word.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+void TriggerHandler::takeCallbacks(int triggerId, std::vector<std::function<void()>>& out) {
+    auto it = callbacks.find(triggerId);
+    if (it == callbacks.end()) return;
+    out.swap(it->second);
+    callbacks.erase(it);
+    updateWaitedMark(triggerId);
+}
+
+void TriggerHandler::wakeWaiters(int triggerId) {
+    auto it = waitLists.find(triggerId);
+    if (it == waitLists.end()) return;
+    for (WaitNode* node = it->second; node; node = node->next) {
+        node->waiter->cv.notify_one();
+    }
+}
+
+void TriggerHandler::signalFd(const FdRegistration& reg) {
+#if defined(__linux__)
+    std::uint64_t one = 1;
+    ssize_t written = write(reg.writeFd, &one, sizeof(one));
+#else
+    char one = 1;
+    ssize_t written = write(reg.writeFd, &one, 1);  // a full pipe is still readable
+#endif
+    (void)written;
+}
+
+void TriggerHandler::signalFds(int triggerId) {
+    for (const FdRegistration& reg : fdRegistrations) {
+        if (std::find(reg.ids.begin(), reg.ids.end(), triggerId) != reg.ids.end()) signalFd(reg);
+    }
 }
 
 void TriggerHandler::setTrigger(int triggerId, bool state) {
+    if (isDense(triggerId)) {
+        std::uint64_t bit = std::uint64_t(1) << (triggerId % kBitsPerWord);
+        if (denseDebounced[triggerId / kBitsPerWord].load(std::memory_order_acquire) & bit) {
+            if (filterInput(triggerId, state)) return;
+        }
+    } else if (anySparseDebounced.load(std::memory_order_acquire) && filterInput(triggerId, state)) {
+        return;
+    }
+    applyState(triggerId, state);
+}
+
+void TriggerHandler::applyState(int triggerId, bool state) {
+    if (isDense(triggerId)) {
+        std::uint64_t bit = std::uint64_t(1) << (triggerId % kBitsPerWord);
+        auto& word = denseStates[triggerId / kBitsPerWord];
+        if (!state) {
+            if (word.fetch_and(~bit, std::memory_order_release) & bit) recordEdge(triggerId, false);
+            return;
+        }
+        if (word.fetch_or(bit, std::memory_order_seq_cst) & bit) return; // already active: no edge
+        recordEdge(triggerId, true);
+        // A waiter marks its id before testing its predicate, so if the mark is absent here any
+        // later waiter sees the bit. Otherwise wake that id's waiters under the mutex, so the
+        // notify cannot fall between a waiter's predicate check and its sleep.
+        bool hasWaiters = denseWaited[triggerId / kBitsPerWord].load(std::memory_order_seq_cst) & bit;
+        if (hasWaiters || fdCount.load(std::memory_order_seq_cst) > 0) {
+            std::vector<std::function<void()>> ready;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                wakeWaiters(triggerId);
+                signalFds(triggerId);
+                takeCallbacks(triggerId, ready);
+            }
+            for (auto& callback : ready) callback();
+        }
+        return;
+    }
+    std::vector<std::function<void()>> ready;
     {
         std::lock_guard<std::mutex> lock(mtx);
-        triggerStates[triggerId] = state;
+        bool& current = triggerStates[triggerId];
+        if (current == state) return;
+        current = state;
+        if (state) ++sparseEdgeCounts[triggerId];
+        recordEdge(triggerId, state);
+        // Notify threads waiting on this trigger if setting it to active
+        if (state) {
+            wakeWaiters(triggerId);
+            signalFds(triggerId);
+            takeCallbacks(triggerId, ready);
+        }
     }
-    // Notify waiting threads if setting trigger to active
-    if (state) {
-        cv.notify_all();
+    // One-shot callbacks run outside the lock so they may use the handler again
+    for (auto& callback : ready) callback();
+}
+
+void TriggerHandler::onTrigger(int triggerId, std::function<void()> callback) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        // Register (and mark the id) before testing the state, so a concurrent rising edge either
+        // finds the callback or is visible to the test below
+        std::vector<std::function<void()>>& pending = callbacks[triggerId];
+        pending.push_back(std::move(callback));
+        updateWaitedMark(triggerId);
+        if (!readState(triggerId)) return;
+        callback = std::move(pending.back());
+        pending.pop_back();
+        if (pending.empty()) {
+            callbacks.erase(triggerId);
+            updateWaitedMark(triggerId);
+        }
     }
+    callback();
 }
 
 bool TriggerHandler::isTriggered(int triggerId) {
+    if (isDense(triggerId)) {
+        return readState(triggerId);
+    }
     std::lock_guard<std::mutex> lock(mtx);
-    auto it = triggerStates.find(triggerId);
-    if (it != triggerStates.end()) {
-        return it->second;
+    return readState(triggerId);
+}
+
+int TriggerHandler::waitOn(const int* ids, std::size_t count, bool all, bool hasDeadline,
+                           std::chrono::steady_clock::time_point deadline) {
+    std::size_t fired = 0;
+    auto satisfied = [&]() {
+        for (std::size_t i = 0; i < count; ++i) {
+            bool active = readState(ids[i]);
+            if (all && !active) return false;
+            if (!all && active) {
+                fired = i;
+                return true;
+            }
+        }
+        return all;
+    };
+    std::unique_lock<std::mutex> lock(mtx);
+    if (count == 0) return all ? 0 : -1;
+    if (satisfied()) return static_cast<int>(fired);
+    if (hasDeadline && std::chrono::steady_clock::now() >= deadline) return -1;
+    // One waiter with a node in the list of each id; most waits name only a few ids
+    const std::size_t kInlineNodes = 8;
+    WaitNode inlineNodes[kInlineNodes];
+    std::vector<WaitNode> extraNodes;
+    WaitNode* nodes = inlineNodes;
+    if (count > kInlineNodes) {
+        extraNodes.resize(count);
+        nodes = extraNodes.data();
     }
-    return false;
+    Waiter waiter;
+    for (std::size_t i = 0; i < count; ++i) {
+        nodes[i].waiter = &waiter;
+        linkWaiter(ids[i], nodes[i]);
+    }
+    bool ok;
+    if (hasDeadline) {
+        ok = waiter.cv.wait_until(lock, deadline, satisfied);
+    } else {
+        waiter.cv.wait(lock, satisfied);
+        ok = true;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        unlinkWaiter(ids[i], nodes[i]);
+    }
+    return ok ? static_cast<int>(fired) : -1;
 }
 
 void TriggerHandler::waitForTrigger(int triggerId) {
-    std::unique_lock<std::mutex> lock(mtx);
-    cv.wait(lock, [&]{ return triggerStates[triggerId]; });
+    if (isDense(triggerId) && readState(triggerId)) return;
+    waitOn(&triggerId, 1, false, false, std::chrono::steady_clock::time_point());
     // (Trigger remains in active state until cleared by clearTrigger)
 }
 
+bool TriggerHandler::waitFor(int triggerId, Duration timeout) {
+    if (isDense(triggerId) && readState(triggerId)) return true;
+    return waitOn(&triggerId, 1, false, true, deadlineAfter(timeout)) >= 0;
+}
+
+int TriggerHandler::waitAny(const std::vector<int>& triggerIds, Duration timeout) {
+    int index = waitOn(triggerIds.data(), triggerIds.size(), false, true, deadlineAfter(timeout));
+    return index >= 0 ? triggerIds[index] : kTimedOut;
+}
+
+bool TriggerHandler::waitAll(const std::vector<int>& triggerIds, Duration timeout) {
+    return waitOn(triggerIds.data(), triggerIds.size(), true, true, deadlineAfter(timeout)) >= 0;
+}
+
 void TriggerHandler::clearTrigger(int triggerId) {
+    bool filtered = anySparseDebounced.load(std::memory_order_acquire);
+    if (isDense(triggerId)) {
+        std::uint64_t bit = std::uint64_t(1) << (triggerId % kBitsPerWord);
+        filtered = denseDebounced[triggerId / kBitsPerWord].load(std::memory_order_acquire) & bit;
+    }
+    if (filtered) {
+        // A clear is a command, not an input sample: it bypasses the filter, which restarts
+        // from the inactive level and drops any pending stable-time commit
+        bool found = false;
+        {
+            std::lock_guard<std::mutex> lock(debounceMtx);
+            auto it = debounces.find(triggerId);
+            if (it != debounces.end()) {
+                Debounce& d = it->second;
+                d.committed = d.rawLevel = false;
+                d.runLength = 0;
+                ++d.generation;
+                found = true;
+            }
+        }
+        if (found) {
+            applyCommitted(triggerId, false);
+            return;
+        }
+    }
+    applyState(triggerId, false);
+}
+
+std::uint64_t TriggerHandler::getEdgeCount(int triggerId) {
+    if (isDense(triggerId)) {
+        return denseEdgeCounts[triggerId].load(std::memory_order_relaxed);
+    }
     std::lock_guard<std::mutex> lock(mtx);
-    triggerStates[triggerId] = false;
+    auto it = sparseEdgeCounts.find(triggerId);
+    return it != sparseEdgeCounts.end() ? it->second : 0;
+}
+
+void TriggerHandler::setEventQueue(TriggerEventQueue* queue) {
+    eventQueue.store(queue, std::memory_order_release);
+}
+
+void TriggerHandler::setListener(TriggerListener* listener) {
+    this->listener.store(listener, std::memory_order_release);
+}
+
+int TriggerHandler::openTriggerFd(const std::vector<int>& triggerIds) {
+    FdRegistration reg;
+#if defined(__linux__)
+    reg.readFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reg.readFd < 0) return -1;
+    reg.writeFd = reg.readFd;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+    for (int fd : fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    reg.readFd = fds[0];
+    reg.writeFd = fds[1];
+#endif
+    reg.ids = triggerIds;
+    std::lock_guard<std::mutex> lock(mtx);
+    fdRegistrations.push_back(reg);
+    // Publish the registration before sampling the states: a concurrent rising edge either sees
+    // the count and signals, or is already visible here
+    fdCount.fetch_add(1, std::memory_order_seq_cst);
+    for (int id : triggerIds) {
+        if (readState(id)) {
+            signalFd(fdRegistrations.back());
+            break;
+        }
+    }
+    return reg.readFd;
+}
+
+std::uint64_t TriggerHandler::consumeTriggerFd(int fd) {
+#if defined(__linux__)
+    std::uint64_t count = 0;
+    if (read(fd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) return 0;
+    return count;
+#else
+    std::uint64_t count = 0;
+    char buffer[64];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) count += static_cast<std::uint64_t>(n);
+    return count;
+#endif
+}
+
+bool TriggerHandler::closeTriggerFd(int fd) {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto it = fdRegistrations.begin(); it != fdRegistrations.end(); ++it) {
+        if (it->readFd != fd) continue;
+        close(it->readFd);
+        if (it->writeFd != it->readFd) close(it->writeFd);
+        fdRegistrations.erase(it);
+        fdCount.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool TriggerHandler::filterInput(int triggerId, bool level) {
+    bool commit = false;
+    {
+        std::lock_guard<std::mutex> lock(debounceMtx);
+        auto it = debounces.find(triggerId);
+        if (it == debounces.end()) return false;
+        Debounce& d = it->second;
+        if (level != d.rawLevel) {
+            d.rawLevel = level;
+            d.runLength = 0;
+            ++d.generation;  // cancels a pending stable-time commit
+        }
+        ++d.runLength;
+        if (level == d.committed) return true;  // glitch back to the current state: nothing to do
+        if (d.samples > 0) {
+            if (d.runLength >= d.samples) {
+                d.committed = level;
+                commit = true;
+            }
+        } else if (d.runLength == 1) {
+            timers->schedule(d.stableTime, triggerId, d.generation);
+        }
+    }
+    if (commit) applyCommitted(triggerId, level);
+    return true;
+}
+
+void TriggerHandler::applyCommitted(int triggerId, bool level) {
+    for (;;) {
+        applyState(triggerId, level);
+        // A racing commit (timer, sample or clearTrigger) may have applied its level before this
+        // one landed; re-apply until the applied state is the filter's latest commit
+        std::lock_guard<std::mutex> lock(debounceMtx);
+        auto it = debounces.find(triggerId);
+        if (it == debounces.end() || it->second.committed == level) return;
+        level = it->second.committed;
+    }
+}
+
+void TriggerHandler::onStableTimeout(int triggerId, std::uint64_t generation) {
+    bool level;
+    {
+        std::lock_guard<std::mutex> lock(debounceMtx);
+        auto it = debounces.find(triggerId);
+        if (it == debounces.end()) return;
+        Debounce& d = it->second;
+        if (d.generation != generation || d.rawLevel == d.committed) return;
+        d.committed = d.rawLevel;
+        level = d.committed;
+    }
+    applyCommitted(triggerId, level);
+}
+
+void TriggerHandler::setDebounce(int triggerId, Duration stableTime, unsigned samples) {
+    std::lock_guard<std::mutex> lock(debounceMtx);
+    if (samples == 0 && !timers) {
+        timers.reset(new TimerWheel([this](int id, std::uint64_t tag) { onStableTimeout(id, tag); }));
+    }
+    bool current = isTriggered(triggerId);
+    Debounce& d = debounces[triggerId];
+    d = Debounce{stableTime, samples, current, 0, current, d.generation + 1};
+    if (isDense(triggerId)) {
+        std::uint64_t bit = std::uint64_t(1) << (triggerId % kBitsPerWord);
+        denseDebounced[triggerId / kBitsPerWord].fetch_or(bit, std::memory_order_release);
+    } else {
+        anySparseDebounced.store(true, std::memory_order_release);
+    }
+}
+
+void TriggerHandler::setDebounceTime(int triggerId, Duration stableTime) {
+    setDebounce(triggerId, std::max(stableTime, Duration(1)), 0);
+}
+
+void TriggerHandler::setDebounceSamples(int triggerId, unsigned samples) {
+    setDebounce(triggerId, Duration(0), std::max(samples, 1u));
+}
+
+void TriggerHandler::clearDebounce(int triggerId) {
+    std::lock_guard<std::mutex> lock(debounceMtx);
+    debounces.erase(triggerId);
+    if (isDense(triggerId)) {
+        std::uint64_t bit = std::uint64_t(1) << (triggerId % kBitsPerWord);
+        denseDebounced[triggerId / kBitsPerWord].fetch_and(~bit, std::memory_order_release);
+    }
 }
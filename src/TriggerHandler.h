@@ -1,28 +1,197 @@
 #ifndef TRIGGER_HANDLER_H
 #define TRIGGER_HANDLER_H
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
+#include "Executor.h"
+#include "TimerWheel.h"
+#include "TriggerEventQueue.h"
 
-// Handles digital I/O triggers (e.g., sensor inputs or trigger signals)
+// Receives trigger transitions synchronously, on the thread that changed the trigger.
+// Implementations must be quick and must not call back into the TriggerHandler.
+class TriggerListener {
+public:
+    virtual ~TriggerListener() = default;
+    virtual void onTriggerEdge(int triggerId, bool rising, std::uint64_t timestampNs) = 0;
+};
+
+// Handles digital I/O triggers (e.g., sensor inputs or trigger signals).
+// Dense ids [0, kDenseTriggers) live in an atomic bitset: polling is a single atomic load and
+// set/clear are single atomic read-modify-writes, with no lock. Other ids use a mutex-guarded map.
 class TriggerHandler {
+public:
+    static constexpr int kDenseTriggers = 256;
+    // Returned by waitAny when the timeout expires first
+    static constexpr int kTimedOut = INT_MIN;
+    using Duration = std::chrono::steady_clock::duration;
 private:
-    std::unordered_map<int, bool> triggerStates;
+    static constexpr int kBitsPerWord = 64;
+    std::array<std::atomic<std::uint64_t>, kDenseTriggers / kBitsPerWord> denseStates;
+    // A blocked thread; it sleeps on its own condition variable
+    struct Waiter {
+        std::condition_variable cv;
+    };
+    // Links a waiter into the intrusive waiter list of one trigger id (lives on the waiter's stack)
+    struct WaitNode {
+        Waiter* waiter;
+        WaitNode* prev;
+        WaitNode* next;
+    };
+    std::array<std::atomic<std::uint64_t>, kDenseTriggers> denseEdgeCounts; // rising edges per dense id
+    std::unordered_map<int, bool> triggerStates; // sparse / large ids (guarded by mtx)
+    std::unordered_map<int, std::uint64_t> sparseEdgeCounts; // rising edges per sparse id (guarded by mtx)
+    std::atomic<TriggerEventQueue*> eventQueue;  // optional edge event stream
+    std::atomic<TriggerListener*> listener;      // optional synchronous edge callback
+    // A pollable descriptor signalled on rising edges of any of its ids
+    struct FdRegistration {
+        int readFd;
+        int writeFd;  // same as readFd for an eventfd
+        std::vector<int> ids;
+    };
+    std::vector<FdRegistration> fdRegistrations; // guarded by mtx
+    std::atomic<int> fdCount;                    // lets setTrigger skip the mutex when no fd is open
+    // Per-id input filter; setTrigger feeds it raw levels and it commits stable ones
+    struct Debounce {
+        Duration stableTime;     // > 0: time-based filter
+        unsigned samples;        // > 0: sample-count filter
+        bool rawLevel;           // last level reported by setTrigger
+        unsigned runLength;      // consecutive samples at rawLevel
+        bool committed;          // filtered level last applied
+        std::uint64_t generation; // bumped on every raw change; stale timers are ignored
+    };
+    std::unordered_map<int, Debounce> debounces; // guarded by debounceMtx
+    std::mutex debounceMtx;                      // taken before mtx, never inside it
+    std::array<std::atomic<std::uint64_t>, kDenseTriggers / kBitsPerWord> denseDebounced;
+    std::atomic<bool> anySparseDebounced;
+    std::unique_ptr<TimerWheel> timers;          // created with the first time-based filter
+    std::unordered_map<int, WaitNode*> waitLists; // head of the waiter list per id (guarded by mtx)
+    // One-shot callbacks per id, run on the next rising edge (guarded by mtx)
+    std::unordered_map<int, std::vector<std::function<void()>>> callbacks;
+    // Dense ids with waiters or callbacks; lets setTrigger skip the mutex when nobody waits
+    std::array<std::atomic<std::uint64_t>, kDenseTriggers / kBitsPerWord> denseWaited;
     std::mutex mtx;
-    std::condition_variable cv;
+
+    static bool isDense(int triggerId) { return triggerId >= 0 && triggerId < kDenseTriggers; }
+    // Current state of a trigger; for sparse ids the caller holds mtx
+    bool readState(int triggerId);
+    // Add / remove a node in the waiter list of triggerId (caller holds mtx)
+    void linkWaiter(int triggerId, WaitNode& node);
+    void unlinkWaiter(int triggerId, WaitNode& node);
+    // Count a transition and publish it to the event queue and listener, if attached
+    void recordEdge(int triggerId, bool rising);
+    // Change the (filtered) state of a trigger: edges, waiters, descriptors and callbacks
+    void applyState(int triggerId, bool state);
+    // Apply a level the filter committed, repeating until it matches the filter's latest commit
+    // (commits are made under debounceMtx but applied outside it)
+    void applyCommitted(int triggerId, bool level);
+    // Feed a raw level through the trigger's debounce filter; returns false if it has none
+    bool filterInput(int triggerId, bool level);
+    // Timer expiry for a time-based filter: commit the level if it has not changed since
+    void onStableTimeout(int triggerId, std::uint64_t generation);
+    void setDebounce(int triggerId, Duration stableTime, unsigned samples);
+    // Refresh the dense "has waiters" mark of triggerId (caller holds mtx)
+    void updateWaitedMark(int triggerId);
+    // Move the pending one-shot callbacks of triggerId into out (caller holds mtx)
+    void takeCallbacks(int triggerId, std::vector<std::function<void()>>& out);
+    // Wake every thread waiting on triggerId (caller holds mtx)
+    void wakeWaiters(int triggerId);
+    // Signal every descriptor registered on triggerId (caller holds mtx)
+    void signalFds(int triggerId);
+    static void signalFd(const FdRegistration& reg);
+    // Register once on every listed id and sleep until any (or all) of them are active or the
+    // deadline passes. Returns the index of the id that satisfied the wait, or -1 on timeout.
+    int waitOn(const int* ids, std::size_t count, bool all, bool hasDeadline,
+               std::chrono::steady_clock::time_point deadline);
 public:
     TriggerHandler();
-    // Manually set a trigger state (simulating an external signal)
+    ~TriggerHandler();
+    TriggerHandler(const TriggerHandler&) = delete;
+    TriggerHandler& operator=(const TriggerHandler&) = delete;
+    // Manually set a trigger state (simulating an external signal). For a debounced trigger
+    // this is a raw sample of the input line and the state follows once it is stable.
     void setTrigger(int triggerId, bool state);
+    // Debounce by time: a level must persist for stableTime before the trigger follows it
+    // (the change, and its waiters/listeners, are then applied from the timer thread)
+    void setDebounceTime(int triggerId, Duration stableTime);
+    // Debounce by samples: a level must be reported by `samples` consecutive setTrigger calls
+    void setDebounceSamples(int triggerId, unsigned samples);
+    // Remove the filter; the trigger keeps its current filtered state
+    void clearDebounce(int triggerId);
     // Check if a trigger is currently active
     bool isTriggered(int triggerId);
     // Block until the specified trigger becomes active (one-time wait)
     void waitForTrigger(int triggerId);
-    // Clear the specified trigger (set it to inactive/false)
+    // As waitForTrigger, but give up after timeout; returns whether the trigger became active
+    bool waitFor(int triggerId, Duration timeout);
+    // Block until any listed trigger is active; returns its id, or kTimedOut
+    int waitAny(const std::vector<int>& triggerIds, Duration timeout);
+    // Block until all listed triggers are active at once; returns false on timeout
+    bool waitAll(const std::vector<int>& triggerIds, Duration timeout);
+    // Clear the specified trigger (set it to inactive/false). This bypasses any debounce filter:
+    // the trigger clears at once and the filter restarts from the inactive level.
     void clearTrigger(int triggerId);
+    // Run callback once, when the trigger next becomes active (at once if it already is). It runs
+    // on the thread that set the trigger, outside the handler's lock.
+    void onTrigger(int triggerId, std::function<void()> callback);
+    // Awaitable for coroutines: `co_await triggers.when(TRIG_START);` (see Executor.h)
+    class TriggerAwaiter;
+    TriggerAwaiter when(int triggerId);
+    // Number of inactive -> active transitions of a trigger since construction (monotonic)
+    std::uint64_t getEdgeCount(int triggerId);
+    // Stream every transition (rising and falling) as a timestamped event into queue;
+    // pass nullptr to stop. The queue must outlive its use here.
+    void setEventQueue(TriggerEventQueue* queue);
+    // Call listener on every transition (e.g. a PositionLatch); pass nullptr to stop.
+    // The listener must outlive its use here.
+    void setListener(TriggerListener* listener);
+    // Open a non-blocking descriptor that becomes readable when any of triggerIds rises (and
+    // immediately if one is already active). Add it to poll/epoll; returns -1 on failure.
+    int openTriggerFd(const std::vector<int>& triggerIds);
+    // Read and reset the descriptor: returns the number of signals since the last read (0 if none)
+    static std::uint64_t consumeTriggerFd(int fd);
+    // Unregister and close a descriptor from openTriggerFd; returns false if it is unknown
+    bool closeTriggerFd(int fd);
 };
 
+// Suspends a coroutine until a trigger is active. The coroutine resumes on the executor that
+// was running it (Executor::current()), or on the setting thread when there is none.
+// await_suspend is templated on the handle type, so this header stays C++17.
+class TriggerHandler::TriggerAwaiter {
+private:
+    TriggerHandler& handler;
+    int triggerId;
+public:
+    TriggerAwaiter(TriggerHandler& handler, int triggerId) : handler(handler), triggerId(triggerId) {}
+    bool await_ready() { return handler.isTriggered(triggerId); }
+    template <class Handle>
+    void await_suspend(Handle handle) {
+        Executor* executor = Executor::current();
+        if (executor) executor->addWork();
+        handler.onTrigger(triggerId, [executor, handle]() mutable {
+            if (!executor) {
+                handle.resume();
+                return;
+            }
+            executor->post([handle]() mutable { handle.resume(); });
+            executor->finishWork();
+        });
+    }
+    void await_resume() {}
+};
+
+inline TriggerHandler::TriggerAwaiter TriggerHandler::when(int triggerId) {
+    return TriggerAwaiter(*this, triggerId);
+}
+
 // Example trigger ID definitions (can be expanded as needed)
 static const int TRIG_START   = 1;
 static const int TRIG_STOP    = 2;
@@ -0,0 +1,80 @@
+#include "catch.hpp"
+#include "Calibration.h"
+
+TEST_CASE("Calibration<3> identity passes points through", "[Calibration]") {
+    Calibration<3> calib;
+    REQUIRE(calib.isAffine());
+    REQUIRE(calib.isInvertible());
+    double p[4] = {1.0, -2.0, 3.0, 45.0};
+    double out[4];
+    calib.apply(p, out, 4);
+    REQUIRE(out[0] == Approx(1.0));
+    REQUIRE(out[1] == Approx(-2.0));
+    REQUIRE(out[2] == Approx(3.0));
+    REQUIRE(out[3] == Approx(45.0)); // beyond the linear axes: untouched
+}
+
+TEST_CASE("Calibration<3> affine transform and inverse round-trip", "[Calibration]") {
+    // Scale X by 2, shear Y by Z, offset Z by -1
+    Calibration<3> calib({2, 0, 0, 10,
+                          0, 1, 0.5, 0,
+                          0, 0, 1, -1,
+                          0, 0, 0, 1});
+    REQUIRE(calib.isAffine());
+    double p[3] = {1.0, 2.0, 4.0};
+    calib.apply(p, p, 3); // in place
+    REQUIRE(p[0] == Approx(12.0));
+    REQUIRE(p[1] == Approx(4.0));
+    REQUIRE(p[2] == Approx(3.0));
+    calib.applyInverse(p, p, 3);
+    REQUIRE(p[0] == Approx(1.0));
+    REQUIRE(p[1] == Approx(2.0));
+    REQUIRE(p[2] == Approx(4.0));
+    // Bottom row of the inverse stays exactly affine
+    const auto& inv = calib.getInverse();
+    REQUIRE(inv[12] == 0.0);
+    REQUIRE(inv[15] == 1.0);
+}
+
+TEST_CASE("Calibration<3> missing linear coordinates are zero", "[Calibration]") {
+    Calibration<3> calib({1, 0, 1, 0,
+                          0, 1, 0, 0,
+                          0, 0, 1, 5,
+                          0, 0, 0, 1});
+    double p[2] = {2.0, 3.0};
+    calib.apply(p, p, 2);
+    REQUIRE(p[0] == Approx(2.0)); // Z taken as 0 contributes nothing
+    REQUIRE(p[1] == Approx(3.0));
+}
+
+TEST_CASE("Calibration<4> projective transform", "[Calibration]") {
+    Calibration<4>::Matrix m = {1, 0, 0, 0, 0,
+                                0, 1, 0, 0, 0,
+                                0, 0, 1, 0, 0,
+                                0, 0, 0, 1, 0,
+                                0.5, 0, 0, 0, 1};
+    Calibration<4> calib(m);
+    REQUIRE_FALSE(calib.isAffine());
+    double p[4] = {2.0, 4.0, 6.0, 8.0};
+    double out[4];
+    calib.apply(p, out, 4);
+    // w' = 0.5 * 2 + 1 = 2
+    REQUIRE(out[0] == Approx(1.0));
+    REQUIRE(out[1] == Approx(2.0));
+    REQUIRE(out[2] == Approx(3.0));
+    REQUIRE(out[3] == Approx(4.0));
+    calib.applyInverse(out, out, 4);
+    REQUIRE(out[0] == Approx(2.0));
+    REQUIRE(out[3] == Approx(8.0));
+}
+
+TEST_CASE("Calibration<3> singular matrix has no inverse", "[Calibration]") {
+    Calibration<3> calib({1, 0, 0, 0,
+                          0, 1, 0, 0,
+                          0, 0, 0, 0,
+                          0, 0, 0, 1});
+    REQUIRE_FALSE(calib.isInvertible());
+    double p[3] = {1.0, 2.0, 3.0};
+    calib.applyInverse(p, p, 3);
+    REQUIRE(p[2] == Approx(3.0));
+}
@@ -1,5 +1,9 @@
 #include "catch.hpp"
 #include "CalibrationManager.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
 
 TEST_CASE("CalibrationManager default (identity) transform", "[CalibrationManager]") {
     CalibrationManager calib;
@@ -46,3 +50,273 @@ TEST_CASE("CalibrationManager custom transform (scale/offset/rotation)", "[Calib
     REQUIRE(out[0] == Approx(0.0));
     REQUIRE(out[1] == Approx(2.0));
 }
+
+TEST_CASE("CalibrationManager batch transform matches per-point path", "[CalibrationManager]") {
+    CalibrationManager calib;
+    // Projective matrix with a non-trivial bottom row
+    std::array<double, 9> mat = {1.1, 0.2, 3.0,
+                                 -0.1, 0.9, -2.0,
+                                 0.001, 0.002, 1.0};
+    calib.setCalibrationMatrix(mat);
+    const std::size_t n = 37; // not a multiple of any SIMD width, exercises the scalar tail
+    std::vector<double> xs(n), ys(n), aos(2 * n), aos3(3 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        xs[i] = -50.0 + 3.0 * i;
+        ys[i] = 20.0 - 1.5 * i;
+        aos[2 * i] = xs[i];
+        aos[2 * i + 1] = ys[i];
+        aos3[3 * i] = xs[i];
+        aos3[3 * i + 1] = ys[i];
+        aos3[3 * i + 2] = 7.0 + i;
+    }
+    std::vector<double> xo(n), yo(n), aosOut(2 * n), aos3Out(3 * n);
+    calib.applyCalibrationBatch(xs.data(), ys.data(), xo.data(), yo.data(), n);
+    calib.applyCalibrationBatch(aos.data(), aosOut.data(), n, 2);
+    calib.applyCalibrationBatch(aos3.data(), aos3Out.data(), n, 3);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto ref = calib.applyCalibration({xs[i], ys[i]});
+        REQUIRE(xo[i] == Approx(ref[0]));
+        REQUIRE(yo[i] == Approx(ref[1]));
+        REQUIRE(aosOut[2 * i] == Approx(ref[0]));
+        REQUIRE(aosOut[2 * i + 1] == Approx(ref[1]));
+        REQUIRE(aos3Out[3 * i] == Approx(ref[0]));
+        REQUIRE(aos3Out[3 * i + 1] == Approx(ref[1]));
+        // Pass-through coordinate is copied unchanged
+        REQUIRE(aos3Out[3 * i + 2] == 7.0 + i);
+    }
+    // In-place SoA transform
+    calib.applyCalibrationBatch(xs.data(), ys.data(), xs.data(), ys.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        REQUIRE(xs[i] == Approx(xo[i]));
+        REQUIRE(ys[i] == Approx(yo[i]));
+    }
+}
+
+TEST_CASE("CalibrationManager batch transform leaves w'=0 points undivided", "[CalibrationManager]") {
+    CalibrationManager calib;
+    // w' = x - 1, which is zero at x = 1
+    std::array<double, 9> mat = {1, 0, 0,
+                                 0, 1, 0,
+                                 1, 0, -1};
+    calib.setCalibrationMatrix(mat);
+    std::vector<double> xs = {1.0, 1.0, 3.0, 1.0, 5.0};
+    std::vector<double> ys = {2.0, 4.0, 6.0, 8.0, 8.0};
+    std::vector<double> xo(xs.size()), yo(ys.size());
+    calib.applyCalibrationBatch(xs.data(), ys.data(), xo.data(), yo.data(), xs.size());
+    REQUIRE(xo[0] == Approx(1.0));
+    REQUIRE(yo[1] == Approx(4.0));
+    REQUIRE(xo[2] == Approx(1.5));
+    REQUIRE(yo[2] == Approx(3.0));
+    REQUIRE(yo[3] == Approx(8.0));
+    REQUIRE(yo[4] == Approx(2.0));
+}
+
+TEST_CASE("CalibrationManager caller-buffer overload", "[CalibrationManager]") {
+    CalibrationManager calib;
+    std::array<double, 9> offsetMat = {1, 0, 5,
+                                       0, 1, 10,
+                                       0, 0, 1};
+    calib.setCalibrationMatrix(offsetMat);
+    const double in[4] = {1.0, 2.0, 3.0, 4.0};
+    double out[4] = {0.0, 0.0, 0.0, 0.0};
+    calib.applyCalibration(in, out, 4);
+    REQUIRE(out[0] == Approx(6.0));
+    REQUIRE(out[1] == Approx(12.0));
+    // Extra coordinates pass through
+    REQUIRE(out[2] == 3.0);
+    REQUIRE(out[3] == 4.0);
+    // In-place use
+    double point[3] = {0.0, 0.0, 9.0};
+    calib.applyCalibration(point, point, 3);
+    REQUIRE(point[0] == Approx(5.0));
+    REQUIRE(point[1] == Approx(10.0));
+    REQUIRE(point[2] == 9.0);
+    // A single coordinate is copied unchanged
+    double single = 7.0, singleOut = 0.0;
+    calib.applyCalibration(&single, &singleOut, 1);
+    REQUIRE(singleOut == 7.0);
+}
+
+TEST_CASE("CalibrationManager classifies calibration matrices", "[CalibrationManager]") {
+    using MC = CalibrationManager::MatrixClass;
+    CalibrationManager calib;
+    REQUIRE(calib.getMatrixClass() == MC::Identity);
+    calib.setCalibrationMatrix({1, 0, 5, 0, 1, -2, 0, 0, 1});
+    REQUIRE(calib.getMatrixClass() == MC::Translation);
+    calib.setCalibrationMatrix({0, -1, 0, 1, 0, 0, 0, 0, 1});
+    REQUIRE(calib.getMatrixClass() == MC::Affine);
+    calib.setCalibrationMatrix({1, 0, 0, 0, 1, 0, 0.001, 0, 1});
+    REQUIRE(calib.getMatrixClass() == MC::Projective);
+    // A non-unit bottom-right entry is a uniform projective scale, not affine
+    calib.setCalibrationMatrix({1, 0, 0, 0, 1, 0, 0, 0, 2});
+    REQUIRE(calib.getMatrixClass() == MC::Projective);
+    auto out = calib.applyCalibration({4.0, 6.0});
+    REQUIRE(out[0] == Approx(2.0));
+    REQUIRE(out[1] == Approx(3.0));
+    calib.setCalibrationMatrix({1, 0, 0, 0, 1, 0, 0, 0, 1});
+    REQUIRE(calib.getMatrixClass() == MC::Identity);
+}
+
+TEST_CASE("CalibrationManager inverse converts stage back to world", "[CalibrationManager]") {
+    CalibrationManager calib;
+    const std::array<std::array<double, 9>, 3> matrices = {{
+        {1, 0, 5, 0, 1, 10, 0, 0, 1},                    // translation
+        {0.9, -0.3, 2.0, 0.25, 1.1, -4.0, 0, 0, 1},       // affine
+        {1.1, 0.2, 3.0, -0.1, 0.9, -2.0, 0.001, 0.002, 1} // projective
+    }};
+    for (const auto& m : matrices) {
+        calib.setCalibrationMatrix(m);
+        REQUIRE(calib.isInvertible());
+        std::vector<double> world = {12.5, -7.25, 3.0};
+        auto stage = calib.applyCalibration(world);
+        auto back = calib.applyInverseCalibration(stage);
+        REQUIRE(back.size() == 3);
+        REQUIRE(back[0] == Approx(world[0]));
+        REQUIRE(back[1] == Approx(world[1]));
+        REQUIRE(back[2] == 3.0);
+        // Batch inverse agrees with the single-point inverse
+        std::vector<double> xs = {stage[0], stage[0], stage[0], stage[0], stage[0]};
+        std::vector<double> ys = {stage[1], stage[1], stage[1], stage[1], stage[1]};
+        calib.applyInverseCalibrationBatch(xs.data(), ys.data(), xs.data(), ys.data(), xs.size());
+        REQUIRE(xs[4] == Approx(world[0]));
+        REQUIRE(ys[4] == Approx(world[1]));
+    }
+    // Affine AoS batch uses the divide-free kernel and matches the single-point path
+    calib.setCalibrationMatrix(matrices[1]);
+    REQUIRE(calib.getMatrixClass() == CalibrationManager::MatrixClass::Affine);
+    std::vector<double> pts = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::vector<double> ptsOut(pts.size());
+    calib.applyCalibrationBatch(pts.data(), ptsOut.data(), 5, 2);
+    for (std::size_t i = 0; i < 5; ++i) {
+        auto ref = calib.applyCalibration({pts[2 * i], pts[2 * i + 1]});
+        REQUIRE(ptsOut[2 * i] == Approx(ref[0]));
+        REQUIRE(ptsOut[2 * i + 1] == Approx(ref[1]));
+    }
+}
+
+TEST_CASE("CalibrationManager singular matrix has no inverse", "[CalibrationManager]") {
+    CalibrationManager calib;
+    // Projects everything onto the X axis
+    calib.setCalibrationMatrix({1, 0, 0, 0, 0, 0, 0, 0, 1});
+    REQUIRE_FALSE(calib.isInvertible());
+    auto out = calib.applyInverseCalibration({3.0, 4.0});
+    REQUIRE(out[0] == 3.0);
+    REQUIRE(out[1] == 4.0);
+}
+
+TEST_CASE("CalibrationManager versions every change", "[CalibrationManager]") {
+    CalibrationManager calib;
+    REQUIRE(calib.getVersion() == 1);
+    calib.setCalibrationMatrix({1, 0, 2, 0, 1, 3, 0, 0, 1});
+    REQUIRE(calib.getVersion() == 2);
+    calib.clearErrorMap();
+    REQUIRE(calib.getVersion() == 3);
+    // A failed load publishes nothing
+    REQUIRE_FALSE(calib.loadErrorMap("/nonexistent/error.map"));
+    REQUIRE(calib.getVersion() == 3);
+    double in[2] = {1.0, 1.0}, out[2];
+    std::uint64_t used = 0;
+    calib.applyCalibration(in, out, 2, &used);
+    REQUIRE(used == 3);
+    REQUIRE(out[0] == Approx(3.0));
+    REQUIRE(out[1] == Approx(4.0));
+}
+
+TEST_CASE("CalibrationManager swaps calibration under concurrent readers", "[CalibrationManager]") {
+    // The writer alternates between two translations; a torn read would mix their offsets
+    CalibrationManager calib;
+    const std::array<double, 9> a = {1, 0, 5, 0, 1, 5, 0, 0, 1};
+    const std::array<double, 9> b = {1, 0, 10, 0, 1, 10, 0, 0, 1};
+    calib.setCalibrationMatrix(a);
+    std::atomic<bool> done(false);
+    std::atomic<int> torn(0), backwards(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            std::uint64_t lastSeen = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                double in[2] = {0.0, 0.0}, out[2];
+                std::uint64_t version = 0;
+                calib.applyCalibration(in, out, 2, &version);
+                if (out[0] != out[1] || (out[0] != 5.0 && out[0] != 10.0)) torn.fetch_add(1);
+                if (version < lastSeen) backwards.fetch_add(1);
+                lastSeen = version;
+            }
+        });
+    }
+    for (int i = 0; i < 20000; ++i) {
+        calib.setCalibrationMatrix((i % 2) ? a : b);
+    }
+    done.store(true);
+    for (auto& r : readers) r.join();
+    REQUIRE(torn.load() == 0);
+    REQUIRE(backwards.load() == 0);
+    REQUIRE(calib.getVersion() == 20002);
+}
+
+TEST_CASE("CalibrationManager 3D calibration with a mapped rotary axis", "[CalibrationManager]") {
+    CalibrationManager calib;
+    REQUIRE(calib.getLinearAxes() == 2);
+    // XYZ: offset Z by 2 and tilt X with Z; theta (axis 3) is scaled by 2 and offset by 1
+    calib.setCalibration(Calibration<3>({1, 0, 0.1, 0,
+                                         0, 1, 0, 0,
+                                         0, 0, 1, 2,
+                                         0, 0, 0, 1}));
+    REQUIRE(calib.getLinearAxes() == 3);
+    REQUIRE(calib.getMatrixClass() == CalibrationManager::MatrixClass::Affine);
+    REQUIRE_FALSE(calib.setAxisMapping(3, 0.0, 1.0));
+    REQUIRE(calib.setAxisMapping(3, 2.0, 1.0));
+    std::vector<double> world = {1.0, 2.0, 10.0, 5.0, 7.0};
+    std::vector<double> stage = calib.applyCalibration(world);
+    REQUIRE(stage[0] == Approx(2.0));
+    REQUIRE(stage[1] == Approx(2.0));
+    REQUIRE(stage[2] == Approx(12.0));
+    REQUIRE(stage[3] == Approx(11.0));
+    REQUIRE(stage[4] == Approx(7.0)); // unmapped axis passes through
+    std::vector<double> back = calib.applyInverseCalibration(stage);
+    for (std::size_t i = 0; i < world.size(); ++i) {
+        REQUIRE(back[i] == Approx(world[i]));
+    }
+    // AoS batch agrees with the single-point path
+    double points[10] = {1.0, 2.0, 10.0, 5.0, 7.0, 1.0, 2.0, 10.0, 5.0, 7.0};
+    calib.applyCalibrationBatch(points, points, 2, 5);
+    for (std::size_t i = 0; i < 10; ++i) {
+        REQUIRE(points[i] == Approx(stage[i % 5]));
+    }
+    // Installing a 2D matrix returns to the planar path; axis mappings stay in force
+    calib.setCalibrationMatrix({1, 0, 0, 0, 1, 0, 0, 0, 1});
+    REQUIRE(calib.getLinearAxes() == 2);
+    stage = calib.applyCalibration(world);
+    REQUIRE(stage[2] == Approx(10.0));
+    REQUIRE(stage[3] == Approx(11.0));
+    calib.clearAxisMappings();
+    REQUIRE(calib.applyCalibration(world)[3] == Approx(5.0));
+}
+
+TEST_CASE("CalibrationManager batch vs per-point benchmark", "[.][benchmark][CalibrationManager]") {
+    CalibrationManager calib;
+    std::array<double, 9> mat = {1.0001, 0.0002, 3.0,
+                                 -0.0001, 0.9998, -2.0,
+                                 1e-6, 2e-6, 1.0};
+    calib.setCalibrationMatrix(mat);
+    const std::size_t n = 100000;
+    std::vector<double> xs(n), ys(n), xo(n), yo(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        xs[i] = (double)(i % 1000);
+        ys[i] = (double)(i / 1000);
+    }
+    auto start = std::chrono::steady_clock::now();
+    double checksum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        auto out = calib.applyCalibration({xs[i], ys[i]});
+        checksum += out[0];
+    }
+    auto mid = std::chrono::steady_clock::now();
+    calib.applyCalibrationBatch(xs.data(), ys.data(), xo.data(), yo.data(), n);
+    auto end = std::chrono::steady_clock::now();
+    double perPointUs = std::chrono::duration<double, std::micro>(mid - start).count();
+    double batchUs = std::chrono::duration<double, std::micro>(end - mid).count();
+    std::cout << "applyCalibration x" << n << ": " << perPointUs << " us, batch: " << batchUs
+              << " us (checksum " << checksum + xo[n - 1] << ")" << std::endl;
+    REQUIRE(xo[n - 1] == Approx(calib.applyCalibration({xs[n - 1], ys[n - 1]})[0]));
+}
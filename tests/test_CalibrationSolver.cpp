@@ -0,0 +1,160 @@
+#include "catch.hpp"
+#include "CalibrationSolver.h"
+#include "CalibrationManager.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+
+// Map a world point through a known matrix to build synthetic fiducials
+PointPair makePair(const std::array<double, 9>& m, double x, double y) {
+    double sx = m[0] * x + m[1] * y + m[2];
+    double sy = m[3] * x + m[4] * y + m[5];
+    double w = m[6] * x + m[7] * y + m[8];
+    return {x, y, sx / w, sy / w};
+}
+
+std::vector<PointPair> makeGrid(const std::array<double, 9>& m, int side, double pitch) {
+    std::vector<PointPair> pairs;
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            pairs.push_back(makePair(m, c * pitch - 50.0, r * pitch - 30.0));
+        }
+    }
+    return pairs;
+}
+
+} // namespace
+
+TEST_CASE("CalibrationSolver recovers an affine matrix", "[CalibrationSolver]") {
+    const std::array<double, 9> truth = {0.999, -0.02, 5.0, 0.021, 1.001, -3.0, 0, 0, 1};
+    auto pairs = makeGrid(truth, 5, 10.0);
+    FitResult fit = CalibrationSolver::fit(pairs);
+    REQUIRE(fit.success);
+    for (int i = 0; i < 9; ++i) {
+        REQUIRE(fit.matrix[i] == Approx(truth[i]).margin(1e-9));
+    }
+    REQUIRE(fit.inlierCount == pairs.size());
+    REQUIRE(fit.rmsError < 1e-9);
+    REQUIRE(fit.residuals.size() == pairs.size());
+}
+
+TEST_CASE("CalibrationSolver recovers a homography", "[CalibrationSolver]") {
+    const std::array<double, 9> truth = {1.02, 0.01, 4.0, -0.015, 0.98, 2.0, 1e-4, -2e-4, 1};
+    auto pairs = makeGrid(truth, 6, 8.0);
+    FitOptions options;
+    options.model = FitOptions::Model::Homography;
+    FitResult fit = CalibrationSolver::fit(pairs, options);
+    REQUIRE(fit.success);
+    for (int i = 0; i < 9; ++i) {
+        REQUIRE(fit.matrix[i] == Approx(truth[i]).margin(1e-7));
+    }
+    REQUIRE(fit.maxError < 1e-6);
+}
+
+TEST_CASE("CalibrationSolver rejects degenerate input", "[CalibrationSolver]") {
+    // Too few points
+    std::vector<PointPair> pairs = {{0, 0, 0, 0}, {1, 0, 1, 0}};
+    REQUIRE_FALSE(CalibrationSolver::fit(pairs).success);
+    // Collinear points cannot determine an affine transform
+    pairs = {{0, 0, 0, 0}, {1, 1, 1, 1}, {2, 2, 2, 2}, {3, 3, 3, 3}};
+    REQUIRE_FALSE(CalibrationSolver::fit(pairs).success);
+}
+
+TEST_CASE("CalibrationSolver RANSAC rejects outliers", "[CalibrationSolver]") {
+    const std::array<double, 9> truth = {1.0, 0.01, 2.0, -0.01, 1.0, -1.0, 0, 0, 1};
+    auto pairs = makeGrid(truth, 10, 5.0);
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    for (auto& p : pairs) {
+        p.stageX += noise(rng);
+        p.stageY += noise(rng);
+    }
+    // Corrupt 15% of the fiducials with gross errors
+    for (std::size_t i = 0; i < pairs.size(); i += 7) {
+        pairs[i].stageX += 3.0;
+        pairs[i].stageY -= 2.0;
+    }
+    FitOptions plain;
+    FitResult lsq = CalibrationSolver::fit(pairs, plain);
+    FitOptions robust;
+    robust.useRansac = true;
+    robust.inlierThreshold = 0.01;
+    FitResult fit = CalibrationSolver::fit(pairs, robust);
+    REQUIRE(fit.success);
+    REQUIRE(fit.inlierCount == pairs.size() - 15);
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        REQUIRE(fit.inliers[i] == (i % 7 != 0));
+    }
+    REQUIRE(fit.rmsError < 0.005);
+    REQUIRE(fit.matrix[2] == Approx(truth[2]).margin(1e-3));
+    // Plain least squares is pulled off by the outliers
+    REQUIRE(std::fabs(lsq.matrix[2] - truth[2]) > std::fabs(fit.matrix[2] - truth[2]));
+}
+
+TEST_CASE("CalibrationSolver RANSAC keeps sampling after a bad first hypothesis on large inputs", "[CalibrationSolver]") {
+    // With 100k pairs a hypothesis drawn from an outlier has a handful of inliers, so the
+    // all-inlier probability underflows 1 - p; that must not end the search after one sample
+    const std::array<double, 9> truth = {1.02, 0.01, 4.0, -0.015, 0.98, 2.0, 1e-4, -2e-4, 1};
+    const std::size_t n = 100000;
+    for (unsigned seed = 1; seed <= 6; ++seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> coord(-50.0, 50.0);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::vector<PointPair> pairs;
+        pairs.reserve(n);
+        std::size_t outliers = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            PointPair p = makePair(truth, coord(rng), coord(rng));
+            if (unit(rng) < 0.3) {
+                p.stageX = coord(rng);
+                p.stageY = coord(rng);
+                ++outliers;
+            }
+            pairs.push_back(p);
+        }
+        FitOptions options;
+        options.model = FitOptions::Model::Homography;
+        options.useRansac = true;
+        options.inlierThreshold = 0.01;
+        options.seed = seed;
+        FitResult fit = CalibrationSolver::fit(pairs, options);
+        REQUIRE(fit.success);
+        REQUIRE(fit.inlierCount >= n - outliers);
+        REQUIRE(fit.inlierCount <= n - outliers + n / 1000);
+        for (int i = 0; i < 9; ++i) {
+            REQUIRE(fit.matrix[i] == Approx(truth[i]).margin(1e-6));
+        }
+    }
+}
+
+TEST_CASE("CalibrationManager installs a fitted matrix", "[CalibrationSolver]") {
+    const std::array<double, 9> truth = {1, 0, 5, 0, 1, 10, 0, 0, 1};
+    CalibrationManager calib;
+    FitResult fit = calib.fitCalibration(makeGrid(truth, 3, 10.0));
+    REQUIRE(fit.success);
+    REQUIRE(calib.getMatrixClass() == CalibrationManager::MatrixClass::Translation);
+    auto out = calib.applyCalibration({0.0, 0.0});
+    REQUIRE(out[0] == Approx(5.0));
+    REQUIRE(out[1] == Approx(10.0));
+    // A failed fit keeps the previous calibration
+    REQUIRE_FALSE(calib.fitCalibration({}).success);
+    out = calib.applyCalibration({0.0, 0.0});
+    REQUIRE(out[0] == Approx(5.0));
+}
+
+TEST_CASE("CalibrationSolver fit time for thousands of fiducials", "[.][benchmark][CalibrationSolver]") {
+    const std::array<double, 9> truth = {1.02, 0.01, 4.0, -0.015, 0.98, 2.0, 1e-5, -2e-5, 1};
+    auto pairs = makeGrid(truth, 70, 3.0); // 4900 fiducials
+    for (std::size_t i = 0; i < pairs.size(); i += 10) pairs[i].stageX += 1.0;
+    FitOptions options;
+    options.model = FitOptions::Model::Homography;
+    options.useRansac = true;
+    auto start = std::chrono::steady_clock::now();
+    FitResult fit = CalibrationSolver::fit(pairs, options);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "RANSAC homography fit of " << pairs.size() << " fiducials: "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+    REQUIRE(fit.success);
+}
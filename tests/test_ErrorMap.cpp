@@ -0,0 +1,226 @@
+#include "catch.hpp"
+#include "ErrorMap.h"
+#include "CalibrationManager.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+
+namespace {
+
+// 3x3 lattice over [0, 20] x [0, 20] with dx = 0.01 * x, dy = -0.02 * y at the nodes
+ErrorMap makeLinearMap() {
+    ErrorMap map;
+    std::vector<float> dx, dy;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            dx.push_back(0.01f * (10.0f * c));
+            dy.push_back(-0.02f * (10.0f * r));
+        }
+    }
+    map.setGrid(0.0, 0.0, 10.0, 10.0, 3, 3, dx, dy);
+    return map;
+}
+
+} // namespace
+
+TEST_CASE("ErrorMap bilinear interpolation and edge clamping", "[ErrorMap]") {
+    ErrorMap map = makeLinearMap();
+    REQUIRE_FALSE(map.isEmpty());
+    double dx, dy;
+    // Exactly on a node
+    map.lookup(10.0, 10.0, dx, dy);
+    REQUIRE(dx == Approx(0.1));
+    REQUIRE(dy == Approx(-0.2));
+    // Inside a cell: linear data is reproduced exactly by bilinear interpolation
+    map.lookup(15.0, 2.5, dx, dy);
+    REQUIRE(dx == Approx(0.15));
+    REQUIRE(dy == Approx(-0.05));
+    // Outside the lattice the nearest edge value is used
+    map.lookup(-100.0, 500.0, dx, dy);
+    REQUIRE(dx == Approx(0.0));
+    REQUIRE(dy == Approx(-0.4));
+    // Batch correction matches single lookups
+    std::vector<double> xs = {0.0, 5.0, 15.0, 25.0, 7.5};
+    std::vector<double> ys = {0.0, 5.0, 12.0, -3.0, 19.0};
+    std::vector<double> xo = xs, yo = ys;
+    map.correctBatch(xo.data(), yo.data(), xo.size());
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        map.lookup(xs[i], ys[i], dx, dy);
+        REQUIRE(xo[i] == Approx(xs[i] + dx));
+        REQUIRE(yo[i] == Approx(ys[i] + dy));
+    }
+}
+
+TEST_CASE("ErrorMap rejects inconsistent grids", "[ErrorMap]") {
+    ErrorMap map;
+    REQUIRE(map.isEmpty());
+    REQUIRE_FALSE(map.setGrid(0, 0, 1, 1, 1, 3, {0, 0, 0}, {0, 0, 0}));
+    REQUIRE_FALSE(map.setGrid(0, 0, 0, 1, 2, 2, {0, 0, 0, 0}, {0, 0, 0, 0}));
+    REQUIRE_FALSE(map.setGrid(0, 0, 1, 1, 2, 2, {0, 0, 0}, {0, 0, 0, 0}));
+    REQUIRE(map.isEmpty());
+    double dx, dy;
+    map.lookup(1.0, 1.0, dx, dy);
+    REQUIRE(dx == 0.0);
+    REQUIRE(dy == 0.0);
+}
+
+TEST_CASE("ErrorMap binary file round-trip", "[ErrorMap]") {
+    ErrorMap map = makeLinearMap();
+    const std::string path = "errormap_roundtrip_test.emap";
+    REQUIRE(map.saveToFile(path));
+    ErrorMap loaded;
+    REQUIRE(loaded.loadFromFile(path));
+    std::remove(path.c_str());
+    REQUIRE(loaded.getCols() == 3);
+    REQUIRE(loaded.getRows() == 3);
+    double dx, dy;
+    loaded.lookup(15.0, 2.5, dx, dy);
+    REQUIRE(dx == Approx(0.15));
+    REQUIRE(dy == Approx(-0.05));
+    REQUIRE_FALSE(loaded.loadFromFile("does_not_exist.emap"));
+}
+
+TEST_CASE("CalibrationManager applies the error map after the matrix", "[ErrorMap]") {
+    CalibrationManager calib;
+    calib.setCalibrationMatrix({1, 0, 5, 0, 1, 0, 0, 0, 1});
+    calib.setErrorMap(makeLinearMap());
+    // (0, 5) -> matrix (5, 5) -> correction (0.05, -0.1)
+    auto out = calib.applyCalibration({0.0, 5.0, 1.0});
+    REQUIRE(out[0] == Approx(5.05));
+    REQUIRE(out[1] == Approx(4.9));
+    REQUIRE(out[2] == 1.0);
+    // Batch paths apply the same correction
+    std::vector<double> xs = {0.0, 3.0}, ys = {5.0, 12.0};
+    calib.applyCalibrationBatch(xs.data(), ys.data(), xs.data(), ys.data(), 2);
+    REQUIRE(xs[0] == Approx(5.05));
+    REQUIRE(ys[0] == Approx(4.9));
+    std::vector<double> aos = {0.0, 5.0, 3.0, 12.0};
+    calib.applyCalibrationBatch(aos.data(), aos.data(), 2, 2);
+    REQUIRE(aos[2] == Approx(xs[1]));
+    REQUIRE(aos[3] == Approx(ys[1]));
+    // Inverse removes the correction and the matrix
+    auto back = calib.applyInverseCalibration(out);
+    REQUIRE(back[0] == Approx(0.0).margin(1e-9));
+    REQUIRE(back[1] == Approx(5.0));
+    calib.applyInverseCalibrationBatch(xs.data(), ys.data(), xs.data(), ys.data(), 2);
+    REQUIRE(xs[1] == Approx(3.0));
+    REQUIRE(ys[1] == Approx(12.0));
+    // Clearing restores matrix-only behaviour
+    calib.clearErrorMap();
+    out = calib.applyCalibration({0.0, 5.0});
+    REQUIRE(out[0] == Approx(5.0));
+    REQUIRE(out[1] == Approx(5.0));
+}
+
+TEST_CASE("ErrorMap ignores non-finite points and batch matches lookups", "[ErrorMap]") {
+    ErrorMap map;
+    std::vector<float> dx, dy;
+    for (int r = 0; r < 7; ++r) {
+        for (int c = 0; c < 9; ++c) {
+            dx.push_back(0.001f * static_cast<float>((c * 7 + r * 3) % 11));
+            dy.push_back(-0.002f * static_cast<float>((c * 5 + r) % 13));
+        }
+    }
+    REQUIRE(map.setGrid(-10.0, 5.0, 2.5, 4.0, 9, 7, dx, dy));
+    double cx, cy;
+    map.lookup(std::nan(""), 1.0, cx, cy);
+    REQUIRE(cx == 0.0);
+    REQUIRE(cy == 0.0);
+    map.lookup(1.0, -std::numeric_limits<double>::infinity(), cx, cy);
+    REQUIRE(cx == 0.0);
+    REQUIRE(cy == 0.0);
+
+    // Points inside, outside and non-finite; odd count exercises the SIMD tail
+    std::vector<double> xs, ys;
+    for (int i = 0; i < 203; ++i) {
+        xs.push_back(-20.0 + 0.37 * i);
+        ys.push_back(0.0 + 0.19 * i);
+    }
+    xs[5] = std::nan("");
+    ys[10] = std::numeric_limits<double>::infinity();
+    xs[11] = 1e300;
+    std::vector<double> xo = xs, yo = ys;
+    map.correctBatch(xo.data(), yo.data(), xo.size());
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        map.lookup(xs[i], ys[i], cx, cy);
+        if (std::isnan(xs[i])) {
+            REQUIRE(std::isnan(xo[i]));
+            REQUIRE(yo[i] == ys[i]);
+            continue;
+        }
+        REQUIRE(xo[i] == Approx(xs[i] + cx));
+        REQUIRE(yo[i] == Approx(ys[i] + cy));
+    }
+    REQUIRE(yo[10] == ys[10]);
+    REQUIRE(xo[10] == xs[10]);
+}
+
+TEST_CASE("ErrorMap rejects a header larger than the file", "[ErrorMap]") {
+    ErrorMap map = makeLinearMap();
+    const std::string path = "errormap_truncated_test.emap";
+    REQUIRE(map.saveToFile(path));
+    // Claim a 65536 x 65536 lattice (32 GiB of node data) in a file holding nine nodes
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        const std::int32_t huge = 65536;
+        file.seekp(12);
+        file.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+        file.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    ErrorMap loaded = makeLinearMap();
+    REQUIRE_FALSE(loaded.loadFromFile(path));
+    REQUIRE(loaded.getCols() == 3);
+    // A file cut short inside the node data is rejected too
+    REQUIRE(map.saveToFile(path));
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 4));
+    }
+    REQUIRE_FALSE(loaded.loadFromFile(path));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ErrorMap rejects non-finite origins, spacings and node deltas", "[ErrorMap]") {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double denormal = std::numeric_limits<double>::denorm_min();
+    const std::vector<float> zeros(4, 0.0f);
+    ErrorMap map;
+    REQUIRE_FALSE(map.setGrid(nan, 0, 1, 1, 2, 2, zeros, zeros));
+    REQUIRE_FALSE(map.setGrid(0, std::numeric_limits<double>::infinity(), 1, 1, 2, 2, zeros, zeros));
+    REQUIRE_FALSE(map.setGrid(0, 0, denormal, 1, 2, 2, zeros, zeros));
+    REQUIRE_FALSE(map.setGrid(0, 0, 1, std::numeric_limits<double>::infinity(), 2, 2, zeros, zeros));
+    REQUIRE_FALSE(map.setGrid(0, 0, 1, 1, 2, 2, {0, 0, std::numeric_limits<float>::quiet_NaN(), 0}, zeros));
+    REQUIRE(map.isEmpty());
+
+    // The same checks guard loadFromFile: patch a NaN origin, then a NaN node, into a saved map
+    const std::string path = "errormap_nonfinite_test.emap";
+    ErrorMap source = makeLinearMap();
+    REQUIRE(source.saveToFile(path));
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(24); // originX
+        file.write(reinterpret_cast<const char*>(&nan), sizeof(nan));
+    }
+    ErrorMap loaded = makeLinearMap();
+    REQUIRE_FALSE(loaded.loadFromFile(path));
+    REQUIRE(source.saveToFile(path));
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        const float badNode = std::numeric_limits<float>::quiet_NaN();
+        file.seekp(56 + 4 * 2 * sizeof(float)); // dx of the centre node
+        file.write(reinterpret_cast<const char*>(&badNode), sizeof(badNode));
+    }
+    REQUIRE_FALSE(loaded.loadFromFile(path));
+    std::remove(path.c_str());
+    double dx, dy;
+    loaded.lookup(15.0, 2.5, dx, dy);
+    REQUIRE(dx == Approx(0.15));
+    REQUIRE(dy == Approx(-0.05));
+}
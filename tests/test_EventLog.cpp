@@ -0,0 +1,111 @@
+#include "catch.hpp"
+#include "EventLog.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+TEST_CASE("EventLog records and formats events", "[EventLog]") {
+    EventLog events(8);
+    const double calib[4] = {0.0, 1.0, 5.0, 1.0};
+    events.record(EventId::CalibrationApplied, -1, calib, 4);
+    const double stage[2] = {5.0, 1.0};
+    events.record(EventId::MoveStarted, -1, stage, 2);
+    events.record(EventId::MoveCompleted);
+    REQUIRE(events.size() == 3);
+    auto text = events.formatAll();
+    REQUIRE(text.size() == 3);
+    REQUIRE(text[0] == std::string("Applied calibration transform: [0.000000,1.000000] -> [5.000000,1.000000]"));
+    REQUIRE(text[1] == std::string("Moving to positions: [5.000000,1.000000]"));
+    REQUIRE(text[2] == std::string("Move completed"));
+    // Timestamps are monotonic
+    auto recs = events.getRecords();
+    REQUIRE(recs[0].timestampNs <= recs[1].timestampNs);
+    REQUIRE(recs[1].timestampNs <= recs[2].timestampNs);
+}
+
+TEST_CASE("EventLog overwrites oldest records when full", "[EventLog]") {
+    EventLog events(2);
+    const double a = 1.0, b = 2.0, c = 3.0;
+    events.record(EventId::AxisMoveFailed, 0, &a, 1);
+    events.record(EventId::AxisMoveFailed, 1, &b, 1);
+    events.record(EventId::AxisMoveFailed, 2, &c, 1);
+    REQUIRE(events.size() == 2);
+    REQUIRE(events.overwrittenCount() == 1);
+    auto recs = events.getRecords();
+    REQUIRE(recs[0].axis == 1);
+    REQUIRE(recs[1].axis == 2);
+    REQUIRE(EventLog::format(recs[1]) == std::string("Error moving axis 3 to position 3.000000"));
+    events.clear();
+    REQUIRE(events.size() == 0);
+    REQUIRE(events.overwrittenCount() == 0);
+}
+
+TEST_CASE("EventLog binary export round-trips", "[EventLog]") {
+    EventLog events(4);
+    const double stage[3] = {1.5, -2.5, 7.0};
+    events.record(EventId::MoveStarted, -1, stage, 3);
+    events.record(EventId::MoveCompleted);
+    const std::string path = "eventlog_roundtrip_test.evt";
+    REQUIRE(events.exportBinary(path));
+    std::vector<EventRecord> loaded;
+    REQUIRE(EventLog::importBinary(path, loaded));
+    std::remove(path.c_str());
+    REQUIRE(loaded.size() == 2);
+    REQUIRE(loaded[0].valueCount == 3);
+    REQUIRE(loaded[0].values[1] == Approx(-2.5));
+    REQUIRE(EventLog::format(loaded[1]) == std::string("Move completed"));
+    // Missing files are reported as failures
+    REQUIRE_FALSE(EventLog::importBinary("does_not_exist.evt", loaded));
+}
+
+TEST_CASE("EventLog import rejects corrupt headers and records", "[EventLog]") {
+    EventLog events(4);
+    const double stage[2] = {1.0, 2.0};
+    events.record(EventId::MoveStarted, -1, stage, 2);
+    events.record(EventId::MoveCompleted);
+    const std::string path = "eventlog_corrupt_test.evt";
+    REQUIRE(events.exportBinary(path));
+    std::string original;
+    {
+        std::ifstream in(path, std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    REQUIRE(original.size() == 24 + 2 * sizeof(EventRecord));
+    auto importPatched = [&](const std::string& bytes) {
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        std::vector<EventRecord> loaded;
+        bool ok = EventLog::importBinary(path, loaded);
+        REQUIRE(loaded.size() == (ok ? 2u : 0u));
+        return ok;
+    };
+    REQUIRE(importPatched(original));
+
+    // A huge record count must fail without allocating for it
+    std::string huge = original;
+    const std::uint64_t hugeCount = 1ull << 40;
+    std::memcpy(&huge[16], &hugeCount, sizeof(hugeCount));
+    REQUIRE_FALSE(importPatched(huge));
+    // Count one short of the data, and a truncated file
+    std::string shortCount = original;
+    const std::uint64_t one = 1;
+    std::memcpy(&shortCount[16], &one, sizeof(one));
+    REQUIRE_FALSE(importPatched(shortCount));
+    REQUIRE_FALSE(importPatched(original.substr(0, original.size() - 8)));
+
+    // A record claiming more than kMaxValues values
+    std::string badValues = original;
+    const std::uint16_t tooMany = 1000;
+    std::memcpy(&badValues[24 + offsetof(EventRecord, valueCount)], &tooMany, sizeof(tooMany));
+    REQUIRE_FALSE(importPatched(badValues));
+    std::remove(path.c_str());
+
+    // format never reads past values[kMaxValues]
+    EventRecord rec = {};
+    rec.id = static_cast<std::uint16_t>(EventId::MoveStarted);
+    rec.valueCount = 1000;
+    REQUIRE(EventLog::format(rec) == std::string("Moving to positions: [0.000000,0.000000,0.000000,0.000000]"));
+}
@@ -0,0 +1,157 @@
+#include "catch.hpp"
+#include "Executor.h"
+#include "Recipe.h"
+#include "TriggerHandler.h"
+#include "MotionController.h"
+#include "CalibrationManager.h"
+#include "SafetyMonitor.h"
+#include "Logger.h"
+#include <thread>
+#include <vector>
+
+namespace {
+// Stand-in for a coroutine handle so the awaiters can be driven without C++20
+struct FakeHandle {
+    int* resumed;
+    void resume() { ++*resumed; }
+};
+}
+
+TEST_CASE("Executor runs posted tasks in order", "[Executor]") {
+    Executor executor;
+    std::vector<int> order;
+    REQUIRE(Executor::current() == nullptr);
+    executor.post([&]() {
+        order.push_back(1);
+        REQUIRE(Executor::current() == &executor);
+        executor.post([&]() { order.push_back(3); });
+    });
+    executor.post([&]() { order.push_back(2); });
+    executor.run();
+    REQUIRE(order == std::vector<int>({1, 2, 3}));
+    REQUIRE(Executor::current() == nullptr);
+    REQUIRE(executor.poll() == 0);
+}
+
+TEST_CASE("Executor run waits for outstanding work", "[Executor]") {
+    Executor executor;
+    bool ran = false;
+    executor.addWork();
+    std::thread t([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        executor.post([&]() { ran = true; });
+        executor.finishWork();
+    });
+    executor.run();
+    t.join();
+    REQUIRE(ran);
+}
+
+TEST_CASE("Executor stop issued before run is not lost", "[Executor]") {
+    Executor executor;
+    bool ran = false;
+    executor.addWork();  // would keep run() waiting without the stop
+    executor.post([&]() { ran = true; });
+    executor.stop();
+    executor.run();
+    REQUIRE_FALSE(ran);
+    // run() keeps honouring the stop until restart()
+    executor.run();
+    REQUIRE_FALSE(ran);
+    executor.restart();
+    executor.finishWork();
+    executor.run();
+    REQUIRE(ran);
+}
+
+TEST_CASE("TriggerHandler onTrigger runs once on the next rising edge", "[Executor][TriggerHandler]") {
+    TriggerHandler triggers;
+    int calls = 0;
+    triggers.onTrigger(TRIG_START, [&]() { ++calls; });
+    REQUIRE(calls == 0);
+    triggers.setTrigger(TRIG_START, true);
+    REQUIRE(calls == 1);
+    triggers.clearTrigger(TRIG_START);
+    triggers.setTrigger(TRIG_START, true);
+    REQUIRE(calls == 1);
+    // Already active: runs immediately
+    triggers.onTrigger(TRIG_START, [&]() { ++calls; });
+    REQUIRE(calls == 2);
+    triggers.onTrigger(80000, [&]() { ++calls; });
+    triggers.setTrigger(80000, true);
+    REQUIRE(calls == 3);
+}
+
+TEST_CASE("Trigger and move awaiters resume through the executor", "[Executor]") {
+    CalibrationManager calib;
+    TriggerHandler triggers;
+    SafetyMonitor safety(1);
+    Logger logger;
+    MotionController ctrl(calib, triggers, safety, logger, 1);
+    ctrl.initialize();
+    Executor executor;
+    int resumed = 0;
+    // The awaiters reference their targets and must outlive the resumption, as in a coroutine frame
+    const std::vector<double> first{12.0}, second{3.0};
+    auto trig = triggers.when(TRIG_CAPTURE);
+    auto move = ctrl.moveAsync(first);
+    executor.post([&]() {
+        REQUIRE_FALSE(trig.await_ready());
+        trig.await_suspend(FakeHandle{&resumed});
+        REQUIRE(move.await_suspend(FakeHandle{&resumed}));
+    });
+    // The move resumes from the completion thread once the axes report it done; the pending
+    // trigger keeps run() from returning, so stop it after the resumption
+    executor.post([&]() {
+        ctrl.whenMoveDone([&](const CML::Error*) { executor.post([&]() { executor.stop(); }); });
+    });
+    executor.run();
+    REQUIRE(resumed == 1);
+    REQUIRE(move.await_resume() == CML::SUCCESS);
+    REQUIRE(ctrl.getAxisPosition(0) == Approx(12.0));
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    REQUIRE(executor.poll() == 1);
+    REQUIRE(resumed == 2);
+    // Without an executor the move awaiter waits for completion in place and does not suspend
+    auto direct = ctrl.moveAsync(second);
+    REQUIRE_FALSE(direct.await_suspend(FakeHandle{&resumed}));
+    REQUIRE(direct.await_resume() == CML::SUCCESS);
+    REQUIRE(ctrl.getAxisPosition(0) == Approx(3.0));
+}
+
+#ifdef INSPECTION_HAS_COROUTINES
+namespace {
+Recipe inspect(MotionController& ctrl, TriggerHandler& triggers, int index, int& finished, int& failures) {
+    std::vector<double> target(1, static_cast<double>(index));
+    if (co_await ctrl.moveAsync(target) != CML::SUCCESS) ++failures;
+    co_await triggers.when(TRIG_START);
+    target[0] = -target[0];
+    if (co_await ctrl.moveAsync(target) != CML::SUCCESS) ++failures;
+    ++finished;
+}
+}
+
+TEST_CASE("Thousands of recipe coroutines share one executor thread", "[Executor]") {
+    CalibrationManager calib;
+    TriggerHandler triggers;
+    SafetyMonitor safety(1);
+    Logger logger;
+    logger.setLevel(LogLevel::Warning);
+    MotionController ctrl(calib, triggers, safety, logger, 1);
+    ctrl.initialize();
+    Executor executor;
+    const int recipes = 2000;
+    int finished = 0, failures = 0;
+    for (int i = 0; i < recipes; ++i) {
+        inspect(ctrl, triggers, i, finished, failures).spawn(executor);
+    }
+    std::thread signal([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        triggers.setTrigger(TRIG_START, true);
+    });
+    executor.run(); // returns once every recipe has finished
+    signal.join();
+    REQUIRE(finished == recipes);
+    REQUIRE(failures == 0);
+}
+#endif
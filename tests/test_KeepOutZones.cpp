@@ -0,0 +1,285 @@
+#include "catch.hpp"
+#include "KeepOutZones.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+TEST_CASE("KeepOutZones point queries for each shape", "[KeepOutZones]") {
+    KeepOutZones zones;
+    const double boxLo[3] = {0.0, 0.0, 0.0};
+    const double boxHi[3] = {10.0, 10.0, 5.0};
+    int box = zones.addBox(boxLo, boxHi);
+    int cylinder = zones.addCylinder(50.0, 50.0, 5.0, -1.0, 20.0);
+    // L-shaped (non-convex) polygon
+    int polygon = zones.addPolygon({100.0, 0.0, 120.0, 0.0, 120.0, 5.0, 105.0, 5.0, 105.0, 20.0, 100.0, 20.0},
+                                   0.0, 10.0);
+    REQUIRE(zones.size() == 3);
+
+    const double inBox[3] = {5.0, 5.0, 1.0};
+    const double onBoxFace[3] = {10.0, 5.0, 1.0};
+    const double aboveBox[3] = {5.0, 5.0, 6.0};
+    REQUIRE(zones.findZone(inBox, 3) == box);
+    REQUIRE(zones.findZone(onBoxFace, 3) == box); // zones are closed
+    REQUIRE(zones.findZone(aboveBox, 3) == -1);
+
+    const double inCylinder[3] = {53.0, 53.0, 0.0};
+    const double cylinderCorner[3] = {54.5, 54.5, 0.0}; // inside the bounding box only
+    REQUIRE(zones.findZone(inCylinder, 3) == cylinder);
+    REQUIRE(zones.findZone(cylinderCorner, 3) == -1);
+
+    const double inLeg[2] = {102.0, 15.0};
+    const double inNotch[2] = {110.0, 15.0}; // inside the bounding box, outside the L
+    REQUIRE(zones.findZone(inLeg, 2) == polygon); // Z taken as 0
+    REQUIRE(zones.findZone(inNotch, 2) == -1);
+}
+
+TEST_CASE("KeepOutZones segment queries report the entry parameter", "[KeepOutZones]") {
+    KeepOutZones zones;
+    const double boxLo[3] = {10.0, -1.0, -1.0};
+    const double boxHi[3] = {20.0, 1.0, 1.0};
+    int box = zones.addBox(boxLo, boxHi);
+    int cylinder = zones.addCylinder(50.0, 0.0, 2.0, -1.0, 1.0);
+    double t;
+    int zone;
+    // Crosses the box first, entering a tenth of the way along
+    const double a[3] = {0.0, 0.0, 0.0};
+    const double b[3] = {100.0, 0.0, 0.0};
+    REQUIRE(zones.intersectSegment(a, b, 3, t, zone));
+    REQUIRE(zone == box);
+    REQUIRE(t == Approx(0.1));
+    // Past the box, hits the cylinder at x = 48
+    const double c[3] = {30.0, 0.0, 0.0};
+    const double d[3] = {60.0, 0.0, 0.0};
+    REQUIRE(zones.intersectSegment(c, d, 3, t, zone));
+    REQUIRE(zone == cylinder);
+    REQUIRE(t == Approx(18.0 / 30.0));
+    // Passes over both zones
+    const double e[3] = {0.0, 0.0, 2.0};
+    const double f[3] = {100.0, 0.0, 2.0};
+    REQUIRE_FALSE(zones.intersectSegment(e, f, 3, t, zone));
+    // Descends into the cylinder from above: enters at z = 1
+    const double g[3] = {50.0, 0.0, 3.0};
+    const double h[3] = {50.0, 0.0, -1.0};
+    REQUIRE(zones.intersectSegment(g, h, 3, t, zone));
+    REQUIRE(zone == cylinder);
+    REQUIRE(t == Approx(0.5));
+}
+
+TEST_CASE("KeepOutZones segment crossing a polygon notch", "[KeepOutZones]") {
+    KeepOutZones zones;
+    // U shape: two legs joined at the bottom, open between x = 5 and x = 15 above y = 5
+    int u = zones.addPolygon({0.0, 0.0, 20.0, 0.0, 20.0, 20.0, 15.0, 20.0, 15.0, 5.0,
+                              5.0, 5.0, 5.0, 20.0, 0.0, 20.0}, -1.0, 1.0);
+    double t;
+    int zone;
+    // Straight down the open middle stops at the bottom bar (y = 5)
+    const double a[2] = {10.0, 30.0};
+    const double b[2] = {10.0, 0.0};
+    REQUIRE(zones.intersectSegment(a, b, 2, t, zone));
+    REQUIRE(zone == u);
+    REQUIRE(t == Approx(25.0 / 30.0));
+    // Inside the notch without touching the polygon
+    const double c[2] = {7.0, 10.0};
+    const double d[2] = {13.0, 18.0};
+    REQUIRE_FALSE(zones.intersectSegment(c, d, 2, t, zone));
+    // Sliding along an edge counts as contact
+    const double e[2] = {5.0, 30.0};
+    const double f[2] = {5.0, 10.0};
+    REQUIRE(zones.intersectSegment(e, f, 2, t, zone));
+    REQUIRE(t == Approx(0.5));
+    // Starting inside a leg
+    const double g[2] = {2.0, 10.0};
+    const double h[2] = {-5.0, 10.0};
+    REQUIRE(zones.intersectSegment(g, h, 2, t, zone));
+    REQUIRE(t == 0.0);
+}
+
+TEST_CASE("KeepOutZones rejects degenerate zones and reuses removed ids", "[KeepOutZones]") {
+    KeepOutZones zones;
+    const double lo[3] = {0.0, 0.0, 0.0};
+    const double hi[3] = {1.0, 1.0, 1.0};
+    REQUIRE(zones.addBox(hi, lo) == -1);
+    REQUIRE(zones.addCylinder(0.0, 0.0, 0.0, 0.0, 1.0) == -1);
+    REQUIRE(zones.addPolygon({0.0, 0.0, 1.0, 1.0}, 0.0, 1.0) == -1);
+    REQUIRE(zones.size() == 0);
+    REQUIRE(zones.treeHeight() == -1);
+
+    int a = zones.addBox(lo, hi);
+    int b = zones.addCylinder(5.0, 5.0, 1.0, 0.0, 1.0);
+    REQUIRE(zones.removeZone(a));
+    REQUIRE_FALSE(zones.removeZone(a));
+    const double inA[3] = {0.5, 0.5, 0.5};
+    REQUIRE(zones.findZone(inA, 3) == -1);
+    REQUIRE(zones.addBox(lo, hi) == a);
+    REQUIRE(zones.findZone(inA, 3) == a);
+    REQUIRE(zones.size() == 2);
+    zones.clear();
+    REQUIRE(zones.size() == 0);
+    REQUIRE(zones.findZone(inA, 3) == -1);
+    (void)b;
+}
+
+TEST_CASE("KeepOutZones loads zones from a text file", "[KeepOutZones]") {
+    const std::string path = "keepout_zones_test.txt";
+    {
+        std::ofstream out(path);
+        out << "# fixture clamps\n"
+            << "box 0 0 0 10 10 5\n"
+            << "\n"
+            << "cylinder 50 50 5 -1 20   # probe head\n"
+            << "polygon 0 10 100 0 120 0 120 5 100 5\n";
+    }
+    KeepOutZones zones;
+    REQUIRE(zones.loadFromFile(path));
+    REQUIRE(zones.size() == 3);
+    const double inCylinder[3] = {50.0, 52.0, 0.0};
+    REQUIRE(zones.findZone(inCylinder, 3) == 1);
+
+    // A malformed line leaves the loaded set in place
+    {
+        std::ofstream out(path);
+        out << "box 0 0 0 1 1 1\n"
+            << "cylinder 5 5 oops 0 1\n";
+    }
+    REQUIRE_FALSE(zones.loadFromFile(path));
+    REQUIRE(zones.size() == 3);
+    {
+        std::ofstream out(path);
+        out << "sphere 0 0 0 1\n";
+    }
+    REQUIRE_FALSE(zones.loadFromFile(path));
+    REQUIRE_FALSE(zones.loadFromFile("keepout_zones_missing.txt"));
+    REQUIRE(zones.size() == 3);
+    std::remove(path.c_str());
+}
+
+namespace {
+// Reference answers from one single-zone set per zone (no shared tree)
+struct BruteForce {
+    std::vector<KeepOutZones> single;
+    std::vector<bool> active;
+};
+} // namespace
+
+TEST_CASE("KeepOutZones tree queries match a scan over all zones under incremental edits", "[KeepOutZones]") {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(0.0, 1000.0);
+    std::uniform_real_distribution<double> size(1.0, 40.0);
+    KeepOutZones zones;
+    BruteForce reference;
+    auto addRandom = [&]() {
+        KeepOutZones one;
+        int id;
+        double x = pos(rng), y = pos(rng), z = pos(rng) * 0.1;
+        switch (rng() % 3) {
+        case 0: {
+            const double lo[3] = {x, y, z};
+            const double hi[3] = {x + size(rng), y + size(rng), z + size(rng)};
+            id = zones.addBox(lo, hi);
+            one.addBox(lo, hi);
+            break;
+        }
+        case 1: {
+            double r = size(rng), h = size(rng);
+            id = zones.addCylinder(x, y, r, z, z + h);
+            one.addCylinder(x, y, r, z, z + h);
+            break;
+        }
+        default: {
+            double s = size(rng);
+            std::vector<double> tri{x, y, x + s, y, x, y + s};
+            id = zones.addPolygon(tri, z, z + s);
+            one.addPolygon(tri, z, z + s);
+            break;
+        }
+        }
+        if (id >= static_cast<int>(reference.single.size())) {
+            reference.single.resize(id + 1);
+            reference.active.resize(id + 1, false);
+        }
+        reference.single[id] = std::move(one);
+        reference.active[id] = true;
+    };
+    for (int i = 0; i < 300; ++i) addRandom();
+    // Remove some zones and add others, exercising leaf removal and id reuse
+    for (int id = 0; id < 300; id += 3) {
+        REQUIRE(zones.removeZone(id));
+        reference.active[id] = false;
+    }
+    for (int i = 0; i < 50; ++i) addRandom();
+    REQUIRE(zones.size() == 250);
+    REQUIRE(zones.treeHeight() <= 8 + 2 * 8);
+
+    for (int q = 0; q < 400; ++q) {
+        const double a[3] = {pos(rng), pos(rng), pos(rng) * 0.1};
+        const double b[3] = {pos(rng), pos(rng), pos(rng) * 0.1};
+        double expectedT = 2.0;
+        bool expectedInside = false;
+        for (std::size_t id = 0; id < reference.single.size(); ++id) {
+            if (!reference.active[id]) continue;
+            double t;
+            int zone;
+            if (reference.single[id].intersectSegment(a, b, 3, t, zone) && t < expectedT) expectedT = t;
+            if (reference.single[id].findZone(a, 3) >= 0) expectedInside = true;
+        }
+        double t;
+        int zone;
+        bool hit = zones.intersectSegment(a, b, 3, t, zone);
+        REQUIRE(hit == (expectedT <= 1.0));
+        if (hit) {
+            REQUIRE(t == Approx(expectedT));
+            REQUIRE(reference.active[zone]);
+        }
+        REQUIRE((zones.findZone(a, 3) >= 0) == expectedInside);
+    }
+}
+
+TEST_CASE("KeepOutZones segment query benchmark", "[.][benchmark][KeepOutZones]") {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> pos(0.0, 10000.0);
+    KeepOutZones zones;
+    std::vector<KeepOutZones> single(1000);
+    for (int i = 0; i < 1000; ++i) {
+        double x = pos(rng), y = pos(rng);
+        zones.addCylinder(x, y, 20.0, 0.0, 50.0);
+        single[i].addCylinder(x, y, 20.0, 0.0, 50.0);
+    }
+    std::vector<double> points(3 * 10000);
+    for (std::size_t i = 0; i < points.size(); i += 3) {
+        points[i] = pos(rng);
+        points[i + 1] = pos(rng);
+        points[i + 2] = 10.0;
+    }
+    const std::size_t segments = points.size() / 3 - 1;
+    auto start = std::chrono::steady_clock::now();
+    std::size_t hitsTree = 0;
+    for (std::size_t k = 0; k < segments; ++k) {
+        // Short segments, as in a dense recipe path
+        double end[3] = {points[3 * k] + 30.0, points[3 * k + 1] + 30.0, 10.0};
+        double t;
+        int zone;
+        if (zones.intersectSegment(&points[3 * k], end, 3, t, zone)) ++hitsTree;
+    }
+    auto tree = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    std::size_t hitsScan = 0;
+    for (std::size_t k = 0; k < segments; ++k) {
+        double end[3] = {points[3 * k] + 30.0, points[3 * k + 1] + 30.0, 10.0};
+        for (const KeepOutZones& one : single) {
+            double t;
+            int zone;
+            if (one.intersectSegment(&points[3 * k], end, 3, t, zone)) {
+                ++hitsScan;
+                break;
+            }
+        }
+    }
+    auto scan = std::chrono::steady_clock::now() - start;
+    REQUIRE(hitsTree == hitsScan);
+    std::cout << "KeepOutZones: 1000 zones, " << segments << " segments: tree "
+              << std::chrono::duration_cast<std::chrono::microseconds>(tree).count() << " us, scan "
+              << std::chrono::duration_cast<std::chrono::microseconds>(scan).count() << " us\n";
+}
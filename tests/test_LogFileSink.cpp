@@ -0,0 +1,193 @@
+#include "catch.hpp"
+#include "LogFileSink.h"
+#include "Logger.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string makeTempDir() {
+    char tmpl[] = "/tmp/logsink_test_XXXXXX";
+    char* dir = mkdtemp(tmpl);
+    return dir ? std::string(dir) : std::string(".");
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+} // namespace
+
+TEST_CASE("LogFileSink appends records and trims the segment on close", "[LogFileSink]") {
+    std::string dir = makeTempDir();
+    std::string prefix = dir + "/run";
+    std::string path;
+    {
+        LogFileSink sink(prefix, 4096, 1 << 20);
+        REQUIRE(sink.isOpen());
+        REQUIRE(sink.append("first"));
+        REQUIRE(sink.append("second"));
+        path = sink.currentPath();
+        // No msync yet: cadence is 1 MiB of appended data
+        REQUIRE(sink.syncCount() == 0);
+    }
+    REQUIRE(readFile(path) == std::string("first\nsecond\n"));
+    std::remove(path.c_str());
+    std::remove(dir.c_str());
+}
+
+TEST_CASE("LogFileSink rotates segments and syncs on cadence", "[LogFileSink]") {
+    std::string dir = makeTempDir();
+    std::string prefix = dir + "/rot";
+    std::string firstPath, secondPath;
+    {
+        LogFileSink sink(prefix, 64, 32);
+        firstPath = sink.currentPath();
+        unsigned firstSegment = sink.currentSegment();
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(sink.append("record-" + std::to_string(i)));  // 9 bytes per record
+        }
+        // 90 bytes do not fit in one 64-byte segment
+        REQUIRE(sink.currentSegment() == firstSegment + 1);
+        secondPath = sink.currentPath();
+        REQUIRE(sink.syncCount() >= 2);
+    }
+    std::string first = readFile(firstPath);
+    std::string second = readFile(secondPath);
+    REQUIRE(first.size() <= 64);
+    REQUIRE(first.rfind("record-0\n", 0) == 0);
+    REQUIRE((first + second).find("record-9\n") != std::string::npos);
+    // A new sink on the same prefix never overwrites earlier segments
+    {
+        LogFileSink again(prefix, 64, 32);
+        REQUIRE(again.currentPath() != firstPath);
+        REQUIRE(again.currentPath() != secondPath);
+        std::remove(again.currentPath().c_str());
+    }
+    std::remove(firstPath.c_str());
+    std::remove(secondPath.c_str());
+    std::remove(dir.c_str());
+}
+
+TEST_CASE("Logger writes through an attached file sink", "[LogFileSink]") {
+    std::string dir = makeTempDir();
+    std::string prefix = dir + "/logger";
+    std::string path;
+    {
+        LogFileSink sink(prefix);
+        path = sink.currentPath();
+        Logger log;
+        log.setFileSink(&sink);
+        log.log("sync message");
+        log.enableAsync(64);
+        log.log("async message");
+        log.disableAsync();
+        log.setFileSink(nullptr);
+        log.log("not in file");
+    }
+    REQUIRE(readFile(path) == std::string("sync message\nasync message\n"));
+    std::remove(path.c_str());
+    std::remove(dir.c_str());
+}
+
+TEST_CASE("LogFileSink rotation skips segments left by an earlier run", "[LogFileSink]") {
+    std::string dir = makeTempDir();
+    std::string prefix = dir + "/crash";
+    // An earlier run left segments 0 and 2 (e.g. 1 was removed by hand after a crash)
+    const std::string old0 = prefix + ".000000.log";
+    const std::string old2 = prefix + ".000002.log";
+    { std::ofstream(old0) << "old segment 0\n"; }
+    { std::ofstream(old2) << "old segment 2\n"; }
+    std::string firstPath, rotatedPath;
+    {
+        LogFileSink sink(prefix, 64, 1 << 20);
+        REQUIRE(sink.currentSegment() == 1);
+        firstPath = sink.currentPath();
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(sink.append("record-" + std::to_string(i)));
+        }
+        // Rotation steps over the existing segment 2 instead of truncating it
+        REQUIRE(sink.currentSegment() == 3);
+        rotatedPath = sink.currentPath();
+    }
+    REQUIRE(readFile(old0) == "old segment 0\n");
+    REQUIRE(readFile(old2) == "old segment 2\n");
+    REQUIRE((readFile(firstPath) + readFile(rotatedPath)).find("record-9\n") != std::string::npos);
+    std::remove(old0.c_str());
+    std::remove(old2.c_str());
+    std::remove(firstPath.c_str());
+    std::remove(rotatedPath.c_str());
+    std::remove(dir.c_str());
+}
+
+#if defined(__linux__)
+TEST_CASE("LogFileSink reserves segment blocks and reports a segment that cannot be reserved", "[LogFileSink]") {
+    std::string dir = makeTempDir();
+    std::string prefix = dir + "/run";
+    {
+        const std::size_t bytes = 256 * 1024;
+        LogFileSink sink(prefix, bytes, 1 << 20);
+        REQUIRE(sink.isOpen());
+        struct stat st;
+        REQUIRE(::stat(sink.currentPath().c_str(), &st) == 0);
+        // Allocated, not sparse
+        REQUIRE(static_cast<std::size_t>(st.st_blocks) * 512 >= bytes);
+        std::remove(sink.currentPath().c_str());
+    }
+    {
+        // Far more than any test filesystem holds: the sink stays closed and leaves no file
+        LogFileSink sink(prefix, std::size_t(1) << 50, 1 << 20);
+        REQUIRE_FALSE(sink.isOpen());
+        REQUIRE_FALSE(sink.append("lost"));
+        struct stat st;
+        REQUIRE(::stat((prefix + ".000000.log").c_str(), &st) != 0);
+    }
+    std::remove(dir.c_str());
+}
+#endif
+
+TEST_CASE("Logger can destroy a detached sink while other threads keep logging", "[LogFileSink]") {
+    std::string dir = makeTempDir();
+    std::string prefix = dir + "/swap";
+    Logger log;
+    log.enableAsync(256);
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 2; ++t) {
+        producers.emplace_back([&log, &stop]() {
+            while (!stop.load()) log.log("busy");
+        });
+    }
+    std::vector<std::string> paths;
+    for (int i = 0; i < 100; ++i) {
+        // Heap-allocated so a sanitizer build flags any write after the delete
+        auto* sink = new LogFileSink(prefix, 4096, 1 << 20);
+        paths.push_back(sink->currentPath());
+        log.setFileSink(sink);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        log.setFileSink(nullptr);
+        delete sink;
+    }
+    stop.store(true);
+    for (auto& th : producers) th.join();
+    log.disableAsync();
+    for (const auto& path : paths) {
+        // Every segment holds whole records only
+        std::string text = readFile(path);
+        REQUIRE(text.size() % 5 == 0);
+        REQUIRE(text.find_first_not_of("busy\n") == std::string::npos);
+        std::remove(path.c_str());
+    }
+    std::remove(dir.c_str());
+}
@@ -1,5 +1,9 @@
 #include "catch.hpp"
 #include "Logger.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST_CASE("Logger stores and clears messages", "[Logger]") {
     Logger log;
@@ -15,17 +19,147 @@ TEST_CASE("Logger stores and clears messages", "[Logger]") {
     REQUIRE(log.getLogs().empty());
 }
 
-TEST_CASE("Multiple Logger instances share log storage", "[Logger]") {
+TEST_CASE("Multiple Logger instances keep independent storage", "[Logger]") {
     Logger log1;
     Logger log2;
-    log1.clear();
     log1.log("Entry A");
     log2.log("Entry B");
-    // Both logger instances should see the combined log messages
+    // Each logger instance sees only its own messages
     const auto& msgs1 = log1.getLogs();
     const auto& msgs2 = log2.getLogs();
-    REQUIRE(msgs1.size() == 2);
-    REQUIRE(msgs2.size() == 2);
+    REQUIRE(msgs1.size() == 1);
+    REQUIRE(msgs2.size() == 1);
     REQUIRE(std::find(msgs1.begin(), msgs1.end(), std::string("Entry A")) != msgs1.end());
-    REQUIRE(std::find(msgs1.begin(), msgs1.end(), std::string("Entry B")) != msgs1.end());
+    REQUIRE(std::find(msgs1.begin(), msgs1.end(), std::string("Entry B")) == msgs1.end());
+    REQUIRE(msgs2[0] == std::string("Entry B"));
+}
+
+TEST_CASE("Logger retention is bounded by entry count", "[Logger]") {
+    Logger log(3, 1024);
+    for (int i = 0; i < 5; ++i) {
+        log.log("Message " + std::to_string(i));
+    }
+    auto messages = log.getLogs();
+    // Oldest entries are overwritten first
+    REQUIRE(messages.size() == 3);
+    REQUIRE(messages[0] == std::string("Message 2"));
+    REQUIRE(messages[2] == std::string("Message 4"));
+    REQUIRE(log.evictedCount() == 2);
+}
+
+TEST_CASE("Logger retention is bounded by byte budget", "[Logger]") {
+    Logger log(100, 32);
+    log.log("0123456789");   // 10 bytes
+    log.log("abcdefghij");   // 10 bytes
+    log.log("ABCDEFGHIJ");   // 10 bytes
+    REQUIRE(log.getLogs().size() == 3);
+    REQUIRE(log.bytesRetained() == 30);
+    // Next message does not fit contiguously: oldest entries are evicted
+    log.log("klmnopqrst");
+    auto messages = log.getLogs();
+    REQUIRE(log.bytesRetained() <= 32);
+    REQUIRE(messages.back() == std::string("klmnopqrst"));
+    REQUIRE(messages.front() != std::string("0123456789"));
+    REQUIRE(log.evictedCount() >= 1);
+    // Messages larger than the whole arena are truncated to fit
+    log.log(std::string(40, 'x'));
+    messages = log.getLogs();
+    REQUIRE(messages.size() == 1);
+    REQUIRE(messages[0] == std::string(32, 'x'));
+    // Clearing empties the store but keeps the eviction counter
+    std::size_t evicted = log.evictedCount();
+    log.clear();
+    REQUIRE(log.getLogs().empty());
+    REQUIRE(log.evictedCount() == evicted);
+}
+
+TEST_CASE("Logger retention keeps empty messages without evicting", "[Logger]") {
+    Logger log(8, 64);
+    log.log("");
+    log.log("a");
+    log.log("");
+    log.log("b");
+    auto messages = log.getLogs();
+    REQUIRE(messages == std::vector<std::string>({"", "a", "", "b"}));
+    REQUIRE(log.evictedCount() == 0);
+    REQUIRE(log.bytesRetained() == 2);
+    // Only empty messages retained: the next message may use the whole arena
+    Logger empties(8, 16);
+    empties.log(std::string(10, 'x'));
+    empties.log("");
+    empties.log("");
+    empties.log(std::string(12, 'y'));  // evicts the 10-byte message only
+    messages = empties.getLogs();
+    REQUIRE(messages == std::vector<std::string>({"", "", std::string(12, 'y')}));
+    REQUIRE(empties.evictedCount() == 1);
+    empties.log(std::string(4, 'z'));
+    REQUIRE(empties.getLogs().size() == 4);
+    REQUIRE(empties.evictedCount() == 1);
+}
+
+TEST_CASE("Logger async mode drains messages in order", "[Logger]") {
+    Logger log;
+    log.clear();
+    log.enableAsync(64);
+    REQUIRE(log.isAsync());
+    log.log("Async 1");
+    log.log("Async 2");
+    log.log("Async 3");
+    // getLogs() drains pending messages before returning
+    auto messages = log.getLogs();
+    REQUIRE(messages.size() == 3);
+    REQUIRE(messages[0] == std::string("Async 1"));
+    REQUIRE(messages[2] == std::string("Async 3"));
+    log.disableAsync();
+    REQUIRE_FALSE(log.isAsync());
+    log.clear();
+}
+
+TEST_CASE("Logger async mode accepts concurrent producers", "[Logger]") {
+    Logger log(4096, 1024 * 1024);
+    log.enableAsync(16);
+    const int producers = 4;
+    const int perProducer = 500;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&log, p]() {
+            for (int i = 0; i < perProducer; ++i) {
+                log.log("P" + std::to_string(p) + " #" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    log.disableAsync();
+    // Every message is either delivered or counted as dropped (small queue forces overflow)
+    std::size_t dropped = log.droppedCount();
+    REQUIRE(log.getLogs().size() + dropped == (std::size_t)(producers * perProducer));
+    log.clear();
+}
+
+TEST_CASE("Logger runtime level filtering skips argument evaluation", "[Logger]") {
+    Logger log;
+    log.clear();
+    log.setLevel(LogLevel::Warning);
+    REQUIRE(log.getLevel() == LogLevel::Warning);
+    REQUIRE_FALSE(log.isEnabled(LogLevel::Info));
+    REQUIRE(log.isEnabled(LogLevel::Error));
+    int evaluations = 0;
+    auto message = [&evaluations](const char* text) {
+        ++evaluations;
+        return std::string(text);
+    };
+    LOG_DEBUG(log, message("debug"));
+    LOG_INFO(log, message("info"));
+    LOG_WARN(log, message("warning"));
+    LOG_ERROR(log, message("error"));
+    // Suppressed statements never build their message
+    REQUIRE(evaluations == 2);
+    auto messages = log.getLogs();
+    REQUIRE(messages.size() == 2);
+    REQUIRE(messages[0] == std::string("warning"));
+    REQUIRE(messages[1] == std::string("error"));
+    // Explicit-level log() calls obey the same threshold
+    log.log(LogLevel::Debug, "dropped");
+    REQUIRE(log.getLogs().size() == 2);
+    log.clear();
 }
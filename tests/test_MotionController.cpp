@@ -4,6 +4,66 @@
 #include "TriggerHandler.h"
 #include "SafetyMonitor.h"
 #include "Logger.h"
+#include "EventLog.h"
+#include "PositionLatch.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+// Count heap allocations so tests can verify allocation-free paths. Every replaceable form is
+// provided (plain, array, nothrow, sized and aligned), all allocating through countedAlloc and
+// releasing through countedFree, so any new/delete pair matches.
+namespace {
+std::atomic<std::size_t> allocationCount{0};
+
+void* countedAlloc(std::size_t size, std::size_t alignment) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void countedFree(void* p) noexcept {
+    std::free(p);
+}
+
+void* countedAllocOrThrow(std::size_t size, std::size_t alignment) {
+    if (void* p = countedAlloc(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+} // namespace
+
+void* operator new(std::size_t size) { return countedAllocOrThrow(size, 0); }
+void* operator new[](std::size_t size) { return countedAllocOrThrow(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }
+void* operator new(std::size_t size, std::align_val_t al) {
+    return countedAllocOrThrow(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al) {
+    return countedAllocOrThrow(size, static_cast<std::size_t>(al));
+}
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, static_cast<std::size_t>(al));
+}
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
 
 TEST_CASE("MotionController initialization and state", "[MotionController]") {
     CalibrationManager calib;
@@ -122,3 +182,159 @@ TEST_CASE("MotionController calibration application", "[MotionController]") {
                 return m.find("Applied calibration transform") != std::string::npos;
             }));
 }
+
+TEST_CASE("MotionController records move events to an attached EventLog", "[MotionController]") {
+    CalibrationManager calib;
+    TriggerHandler triggers;
+    SafetyMonitor safety(2);
+    Logger logger;
+    logger.clear();
+    EventLog events(16);
+    std::array<double, 9> matrix = {1, 0, 5,
+                                    0, 1, 0,
+                                    0, 0, 1};
+    calib.setCalibrationMatrix(matrix);
+    MotionController ctrl(calib, triggers, safety, logger, 2);
+    ctrl.initialize();
+    ctrl.setEventLog(&events);
+    logger.clear();
+    const CML::Error* err = ctrl.moveTo({ 0.0, 0.0 }, true);
+    REQUIRE(err == CML::SUCCESS);
+    REQUIRE(ctrl.getAxisPosition(0) == Approx(5.0));
+    // Per-move events go to the binary log, not to the text logger
+    REQUIRE(logger.getLogs().empty());
+    auto recs = events.getRecords();
+    REQUIRE(recs.size() == 3);
+    REQUIRE(recs[0].id == (std::uint16_t)EventId::CalibrationApplied);
+    REQUIRE(recs[0].values[2] == Approx(5.0));
+    REQUIRE(recs[1].id == (std::uint16_t)EventId::MoveStarted);
+    REQUIRE(recs[2].id == (std::uint16_t)EventId::MoveCompleted);
+    // The completion record carries the calibration version the move used
+    REQUIRE(ctrl.getLastCalibrationVersion() == calib.getVersion());
+    REQUIRE(recs[2].values[0] == Approx((double)calib.getVersion()));
+    REQUIRE(events.formatAll().back() == "Move completed (calibration v" + std::to_string(calib.getVersion()) + ")");
+}
+
+TEST_CASE("MotionController applies a 3D calibration on a 4-axis machine", "[MotionController]") {
+    CalibrationManager calib;
+    TriggerHandler triggers;
+    SafetyMonitor safety(4);
+    Logger logger;
+    // XYZ translation plus a rotary axis offset and scale
+    calib.setCalibration(Calibration<3>({1, 0, 0, 1,
+                                         0, 1, 0, 2,
+                                         0, 0, 1, 3,
+                                         0, 0, 0, 1}));
+    calib.setAxisMapping(3, 0.5, 10.0);
+    MotionController ctrl(calib, triggers, safety, logger, 4);
+    ctrl.initialize();
+    REQUIRE(ctrl.moveTo({ 10.0, 20.0, 30.0, 90.0 }) == CML::SUCCESS);
+    REQUIRE(ctrl.getAxisPosition(0) == Approx(11.0));
+    REQUIRE(ctrl.getAxisPosition(1) == Approx(22.0));
+    REQUIRE(ctrl.getAxisPosition(2) == Approx(33.0));
+    REQUIRE(ctrl.getAxisPosition(3) == Approx(55.0));
+    REQUIRE(ctrl.getLastCalibrationVersion() == calib.getVersion());
+}
+
+TEST_CASE("MotionController honours the logger level threshold", "[MotionController]") {
+    CalibrationManager calib;
+    TriggerHandler triggers;
+    SafetyMonitor safety(1);
+    Logger logger;
+    logger.clear();
+    logger.setLevel(LogLevel::Warning);
+    MotionController ctrl(calib, triggers, safety, logger, 1);
+    ctrl.initialize();
+    REQUIRE(ctrl.moveTo({ 10.0 }) == CML::SUCCESS);
+    // Informational and debug messages are suppressed
+    REQUIRE(logger.getLogs().empty());
+    // Warnings still get through
+    ctrl.emergencyStop();
+    auto logs = logger.getLogs();
+    REQUIRE(logs.size() == 1);
+    REQUIRE(logs[0].find("Emergency Stop engaged") != std::string::npos);
+}
+
+TEST_CASE("MotionController sees an e-stop engaged from a watchdog thread", "[MotionController]") {
+    CalibrationManager calib;
+    TriggerHandler triggers;
+    SafetyMonitor safety(4);
+    Logger logger;
+    logger.setLevel(LogLevel::Error);
+    MotionController ctrl(calib, triggers, safety, logger, 4);
+    ctrl.initialize();
+    std::atomic<bool> started{false};
+    std::thread watchdog([&] {
+        while (!started.load()) std::this_thread::yield();
+        safety.triggerEStop(SafetyMonitor::StopReason::Watchdog);
+    });
+    const std::vector<double> targets{1.0, 2.0, 3.0, 4.0};
+    const CML::Error* err = CML::SUCCESS;
+    // Keep issuing moves; the stop is noticed at the start of a move or between axis commands
+    while (err == CML::SUCCESS) {
+        started.store(true);
+        err = ctrl.moveTo(targets, false);
+    }
+    watchdog.join();
+    REQUIRE(err->code == -101);
+    REQUIRE(ctrl.getState() == MotionController::State::EMERGENCY_STOP);
+    REQUIRE(safety.getStopReason() == SafetyMonitor::StopReason::Watchdog);
+}
+
+TEST_CASE("MotionController calibrated move does not allocate in steady state", "[MotionController]") {
+    CalibrationManager calib;
+    TriggerHandler triggers;
+    SafetyMonitor safety(3);
+    Logger logger;
+    logger.setLevel(LogLevel::Warning);
+    EventLog events(64);
+    std::array<double, 9> matrix = {1, 0, 5,
+                                    0, 1, -5,
+                                    0, 0, 1};
+    calib.setCalibrationMatrix(matrix);
+    MotionController ctrl(calib, triggers, safety, logger, 3);
+    ctrl.initialize();
+    ctrl.setEventLog(&events);
+    const std::vector<double> target = { 10.0, 20.0, 3.0 };
+    // Warm-up move
+    REQUIRE(ctrl.moveTo(target, true) == CML::SUCCESS);
+    std::size_t before = allocationCount.load();
+    for (int i = 0; i < 100; ++i) {
+        ctrl.moveTo(target, true);
+        ctrl.moveTo(target, false);
+    }
+    std::size_t allocations = allocationCount.load() - before;
+    REQUIRE(allocations == 0);
+    REQUIRE(ctrl.getAxisPosition(0) == Approx(10.0));
+    ctrl.moveTo(target, true);
+    REQUIRE(ctrl.getAxisPosition(0) == Approx(15.0));
+    REQUIRE(ctrl.getAxisPosition(1) == Approx(15.0));
+    REQUIRE(ctrl.getAxisPosition(2) == Approx(3.0));
+}
+
+TEST_CASE("PositionLatch capture on trigger does not allocate", "[MotionController][PositionLatch]") {
+    CalibrationManager calib;
+    calib.setCalibrationMatrix({1, 0, 5,
+                                0, 1, -5,
+                                0, 0, 1});
+    TriggerHandler triggers;
+    SafetyMonitor safety(4);
+    Logger logger;
+    MotionController ctrl(calib, triggers, safety, logger, 4);
+    ctrl.initialize();
+    PositionLatch latch(ctrl, 256);
+    latch.setCalibration(&calib);
+    triggers.setListener(&latch);
+    std::uint64_t stamps[256];
+    double positions[256 * 4];
+    std::size_t before = allocationCount.load();
+    for (int i = 0; i < 200; ++i) {
+        triggers.setTrigger(TRIG_CAPTURE, true);
+        triggers.clearTrigger(TRIG_CAPTURE);
+    }
+    std::size_t read = latch.read(stamps, positions, 256);
+    std::size_t allocations = allocationCount.load() - before;
+    triggers.setListener(nullptr);
+    REQUIRE(allocations == 0);
+    REQUIRE(read == 200);
+}
@@ -0,0 +1,83 @@
+#include "catch.hpp"
+#include "PositionLatch.h"
+#include "MotionController.h"
+#include "CalibrationManager.h"
+#include "TriggerHandler.h"
+#include "SafetyMonitor.h"
+#include "Logger.h"
+#include <cstdint>
+
+TEST_CASE("PositionLatch captures all axes on the capture trigger", "[PositionLatch]") {
+    CalibrationManager calib;
+    TriggerHandler triggers;
+    SafetyMonitor safety(3);
+    Logger logger;
+    MotionController ctrl(calib, triggers, safety, logger, 3);
+    ctrl.initialize();
+    PositionLatch latch(ctrl, 8);
+    triggers.setListener(&latch);
+    REQUIRE(latch.axesCount() == 3);
+
+    ctrl.moveTo({ 1.0, 2.0, 3.0 });
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    triggers.clearTrigger(TRIG_CAPTURE);
+    triggers.setTrigger(TRIG_START, true); // other triggers do not latch
+    ctrl.moveTo({ 4.0, 5.0, 6.0 });
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    REQUIRE(latch.available() == 2);
+
+    std::uint64_t stamps[4];
+    double positions[12];
+    REQUIRE(latch.read(stamps, positions, 4) == 2);
+    REQUIRE(positions[0] == Approx(1.0));
+    REQUIRE(positions[2] == Approx(3.0));
+    REQUIRE(positions[3] == Approx(4.0));
+    REQUIRE(positions[5] == Approx(6.0));
+    REQUIRE(stamps[0] <= stamps[1]);
+    REQUIRE(latch.available() == 0);
+    triggers.setListener(nullptr);
+}
+
+TEST_CASE("PositionLatch converts to world coordinates", "[PositionLatch]") {
+    CalibrationManager calib;
+    calib.setCalibrationMatrix({1, 0, 5,
+                                0, 2, 0,
+                                0, 0, 1});
+    TriggerHandler triggers;
+    SafetyMonitor safety(2);
+    Logger logger;
+    MotionController ctrl(calib, triggers, safety, logger, 2);
+    ctrl.initialize();
+    ctrl.moveTo({ 1.0, 3.0 }); // stage (6, 6)
+    PositionLatch latch(ctrl, 4);
+    REQUIRE(latch.capture(10));
+    latch.setCalibration(&calib);
+    REQUIRE(latch.capture(20));
+    double positions[4];
+    REQUIRE(latch.read(nullptr, positions, 4) == 2);
+    REQUIRE(positions[0] == Approx(6.0));
+    REQUIRE(positions[1] == Approx(6.0));
+    REQUIRE(positions[2] == Approx(1.0));
+    REQUIRE(positions[3] == Approx(3.0));
+}
+
+TEST_CASE("PositionLatch drops captures when the ring is full", "[PositionLatch]") {
+    CalibrationManager calib;
+    TriggerHandler triggers;
+    SafetyMonitor safety(1);
+    Logger logger;
+    MotionController ctrl(calib, triggers, safety, logger, 1);
+    ctrl.initialize();
+    PositionLatch latch(ctrl, 2, TRIG_START);
+    REQUIRE(latch.capture(1));
+    REQUIRE(latch.capture(2));
+    REQUIRE_FALSE(latch.capture(3));
+    REQUIRE(latch.overrunCount() == 1);
+    std::uint64_t stamps[4];
+    REQUIRE(latch.read(stamps, nullptr, 1) == 1);
+    REQUIRE(stamps[0] == 1);
+    REQUIRE(latch.capture(4)); // wraps around the ring
+    REQUIRE(latch.read(stamps, nullptr, 4) == 2);
+    REQUIRE(stamps[0] == 2);
+    REQUIRE(stamps[1] == 4);
+}
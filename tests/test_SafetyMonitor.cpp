@@ -1,5 +1,16 @@
 #include "catch.hpp"
 #include "SafetyMonitor.h"
+#include "KeepOutZones.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
 
 TEST_CASE("SafetyMonitor default bounds and basic checks", "[SafetyMonitor]") {
     SafetyMonitor safety(1);
@@ -44,3 +55,314 @@ TEST_CASE("SafetyMonitor emergency stop behavior", "[SafetyMonitor]") {
     REQUIRE(safety.checkPosition({50.0}) == true);
     REQUIRE(safety.checkPosition({-1.0}) == false); // still out of bounds (below min 0)
 }
+
+TEST_CASE("SafetyMonitor latches the first stop reason and timestamp", "[SafetyMonitor]") {
+    SafetyMonitor safety(1);
+    REQUIRE(safety.getStopReason() == SafetyMonitor::StopReason::None);
+    REQUIRE(safety.getStopTimestampNs() == 0);
+    REQUIRE(safety.getStopGeneration() == 0);
+
+    safety.triggerEStop(SafetyMonitor::StopReason::Watchdog);
+    std::uint64_t stamp = safety.getStopTimestampNs();
+    REQUIRE(stamp != 0);
+    REQUIRE(safety.getStopReason() == SafetyMonitor::StopReason::Watchdog);
+    // A second trigger while engaged does not overwrite the latched cause
+    safety.triggerEStop(SafetyMonitor::StopReason::Operator);
+    REQUIRE(safety.getStopReason() == SafetyMonitor::StopReason::Watchdog);
+    REQUIRE(safety.getStopTimestampNs() == stamp);
+    REQUIRE(safety.getStopGeneration() == 1);
+
+    safety.clearEStop();
+    REQUIRE(safety.getStopReason() == SafetyMonitor::StopReason::None);
+    REQUIRE(safety.getStopTimestampNs() == 0);
+    REQUIRE(safety.getStopGeneration() == 1);
+    // The default trigger records an unspecified reason
+    safety.triggerEStop();
+    REQUIRE(safety.getStopReason() == SafetyMonitor::StopReason::Unspecified);
+    REQUIRE(safety.getStopGeneration() == 2);
+}
+
+TEST_CASE("SafetyMonitor stop generation detects a stop that was already cleared", "[SafetyMonitor]") {
+    SafetyMonitor safety(1);
+    std::uint64_t generation = safety.getStopGeneration();
+    REQUIRE_FALSE(safety.stoppedSince(generation));
+    safety.triggerEStop(SafetyMonitor::StopReason::DriveFault);
+    REQUIRE(safety.stoppedSince(generation));
+    safety.clearEStop();
+    // Engaged and cleared in between: still visible to the sampler
+    REQUIRE(safety.stoppedSince(generation));
+    REQUIRE_FALSE(safety.stoppedSince(safety.getStopGeneration()));
+}
+
+TEST_CASE("SafetyMonitor e-stop from another thread is visible with its reason", "[SafetyMonitor]") {
+    SafetyMonitor safety(1);
+    std::thread watchdog([&] {
+        safety.triggerEStop(SafetyMonitor::StopReason::Watchdog);
+    });
+    while (!safety.isEmergencyStop()) {
+        std::this_thread::yield();
+    }
+    // The reason is part of the state word, so it is visible together with the flag
+    REQUIRE(safety.getStopReason() == SafetyMonitor::StopReason::Watchdog);
+    REQUIRE(safety.checkPosition({0.0}) == false);
+    watchdog.join();
+    // The timestamp is published by the engaging thread right after its CAS
+    REQUIRE(safety.getStopTimestampNs() != 0);
+}
+
+TEST_CASE("SafetyMonitor concurrent triggers engage the stop once", "[SafetyMonitor]") {
+    SafetyMonitor safety(1);
+    const SafetyMonitor::StopReason reasons[] = {
+        SafetyMonitor::StopReason::Operator, SafetyMonitor::StopReason::Watchdog,
+        SafetyMonitor::StopReason::LimitViolation, SafetyMonitor::StopReason::External };
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (SafetyMonitor::StopReason reason : reasons) {
+        threads.emplace_back([&safety, &go, reason] {
+            while (!go.load()) std::this_thread::yield();
+            safety.triggerEStop(reason);
+        });
+    }
+    go.store(true);
+    for (auto& t : threads) t.join();
+    REQUIRE(safety.getStopGeneration() == 1);
+    SafetyMonitor::StopReason latched = safety.getStopReason();
+    REQUIRE(std::find(std::begin(reasons), std::end(reasons), latched) != std::end(reasons));
+
+    // Triggers racing clears: a reader only ever sees one of the triggering reasons, and the
+    // generation only moves forward
+    safety.clearEStop();
+    std::atomic<bool> done{false};
+    std::atomic<int> anomalies{0};
+    std::thread reader([&] {
+        std::uint64_t lastGeneration = 0;
+        while (!done.load()) {
+            std::uint64_t generation = 0;
+            safety.isEmergencyStop(generation);
+            if (generation < lastGeneration) ++anomalies;
+            lastGeneration = generation;
+            SafetyMonitor::StopReason reason = safety.getStopReason();
+            if (reason != SafetyMonitor::StopReason::None &&
+                std::find(std::begin(reasons), std::end(reasons), reason) == std::end(reasons)) {
+                ++anomalies;
+            }
+        }
+    });
+    threads.clear();
+    for (SafetyMonitor::StopReason reason : reasons) {
+        threads.emplace_back([&safety, reason] {
+            for (int i = 0; i < 2000; ++i) {
+                safety.triggerEStop(reason);
+                if (i % 2) safety.clearEStop();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    done.store(true);
+    reader.join();
+    REQUIRE(anomalies.load() == 0);
+    REQUIRE(safety.getStopGeneration() >= 2);
+    REQUIRE(safety.getStopGeneration() <= 1 + 4 * 2000);
+}
+
+TEST_CASE("SafetyMonitor checkPath accepts a path inside the bounds", "[SafetyMonitor]") {
+    SafetyMonitor safety(2);
+    safety.setAxisBounds(0, 0.0, 100.0);
+    safety.setAxisBounds(1, 0.0, 50.0);
+    SafetyMonitor::PathViolation violation;
+    REQUIRE(safety.checkPath({{0.0, 0.0}, {100.0, 50.0}, {10.0, 5.0}}, &violation));
+    REQUIRE(violation.kind == SafetyMonitor::PathViolation::Kind::None);
+    // Empty path and single in-bounds point
+    REQUIRE(safety.checkPath({}, &violation));
+    REQUIRE(safety.checkPath({{50.0, 25.0}}, &violation));
+}
+
+TEST_CASE("SafetyMonitor checkPath reports the first crossing segment and parameter", "[SafetyMonitor]") {
+    SafetyMonitor safety(2);
+    safety.setAxisBounds(0, 0.0, 100.0);
+    safety.setAxisBounds(1, 0.0, 50.0);
+    SafetyMonitor::PathViolation violation;
+    // Second segment leaves Y at 50 a quarter of the way along, X later at 100
+    const double points[] = {0.0, 0.0,   40.0, 40.0,   140.0, 80.0};
+    REQUIRE_FALSE(safety.checkPath(points, 3, 2, &violation));
+    REQUIRE(violation.kind == SafetyMonitor::PathViolation::Kind::AxisBounds);
+    REQUIRE(violation.segment == 1);
+    REQUIRE(violation.axis == 1);
+    REQUIRE(violation.t == Approx(0.25));
+    // Leaving through the lower bound
+    REQUIRE_FALSE(safety.checkPath({{10.0, 10.0}, {-10.0, 10.0}}, &violation));
+    REQUIRE(violation.segment == 0);
+    REQUIRE(violation.axis == 0);
+    REQUIRE(violation.t == Approx(0.5));
+    // An out-of-bounds start is reported at t = 0
+    REQUIRE_FALSE(safety.checkPath({{10.0, 60.0}}, &violation));
+    REQUIRE(violation.segment == 0);
+    REQUIRE(violation.t == 0.0);
+    REQUIRE(violation.axis == 1);
+}
+
+TEST_CASE("SafetyMonitor checkPath rejects non-finite points and an engaged e-stop", "[SafetyMonitor]") {
+    SafetyMonitor safety(2);
+    SafetyMonitor::PathViolation violation;
+    REQUIRE_FALSE(safety.checkPath({{0.0, 0.0}, {std::nan(""), 0.0}}, &violation));
+    REQUIRE(violation.kind == SafetyMonitor::PathViolation::Kind::AxisBounds);
+    REQUIRE(violation.axis == 0);
+    safety.triggerEStop(SafetyMonitor::StopReason::Operator);
+    REQUIRE_FALSE(safety.checkPath({{0.0, 0.0}}, &violation));
+    REQUIRE(violation.kind == SafetyMonitor::PathViolation::Kind::EmergencyStop);
+}
+
+TEST_CASE("SafetyMonitor rejects positions and paths through keep-out zones", "[SafetyMonitor]") {
+    SafetyMonitor safety(3);
+    KeepOutZones zones;
+    int clamp = zones.addCylinder(50.0, 0.0, 5.0, -10.0, 10.0);
+    safety.setKeepOutZones(&zones);
+    REQUIRE(safety.checkPosition({0.0, 0.0, 0.0}));
+    REQUIRE_FALSE(safety.checkPosition({52.0, 1.0, 0.0}));
+
+    // Both end points are clear, but the straight line passes through the clamp
+    SafetyMonitor::PathViolation violation;
+    REQUIRE_FALSE(safety.checkPath({{0.0, 0.0, 0.0}, {20.0, 0.0, 0.0}, {100.0, 0.0, 0.0}}, &violation));
+    REQUIRE(violation.kind == SafetyMonitor::PathViolation::Kind::KeepOutZone);
+    REQUIRE(violation.zone == clamp);
+    REQUIRE(violation.segment == 1);
+    REQUIRE(violation.t == Approx(25.0 / 80.0));
+    // Going over the clamp is fine
+    REQUIRE(safety.checkPath({{0.0, 0.0, 20.0}, {100.0, 0.0, 20.0}}, &violation));
+
+    // The earlier of a bounds crossing and a zone entry wins
+    safety.setAxisBounds(0, -100.0, 48.0);
+    REQUIRE_FALSE(safety.checkPath({{0.0, 0.0, 0.0}, {100.0, 0.0, 0.0}}, &violation));
+    REQUIRE(violation.kind == SafetyMonitor::PathViolation::Kind::KeepOutZone);
+    REQUIRE(violation.t == Approx(0.45));
+    safety.setAxisBounds(0, -100.0, 40.0);
+    REQUIRE_FALSE(safety.checkPath({{0.0, 0.0, 0.0}, {100.0, 0.0, 0.0}}, &violation));
+    REQUIRE(violation.kind == SafetyMonitor::PathViolation::Kind::AxisBounds);
+    REQUIRE(violation.t == Approx(0.4));
+
+    safety.setAxisBounds(0, -100.0, 100.0);
+    safety.setKeepOutZones(nullptr);
+    REQUIRE(safety.checkPosition({52.0, 1.0, 0.0}));
+}
+
+TEST_CASE("SafetyMonitor batch check matches per-point checks", "[SafetyMonitor]") {
+    SafetyMonitor safety(3);
+    safety.setAxisBounds(0, -100.0, 100.0);
+    safety.setAxisBounds(1, 0.0, 50.0);
+    safety.setAxisBounds(2, -5.0, 5.0);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> value(-120.0, 120.0);
+    // Odd count so the last mask word and the SIMD tail are partial
+    const std::size_t count = 1000 + 37;
+    std::vector<double> soa(3 * count);
+    for (double& v : soa) v = value(rng);
+    soa[2 * count + 500] = std::nan(""); // non-finite coordinates fail
+    std::vector<std::uint64_t> mask((count + 63) / 64, 0);
+    std::size_t first = safety.checkPositionsBatch(soa.data(), count, 3, mask.data());
+    std::size_t expectedFirst = count;
+    for (std::size_t i = 0; i < count; ++i) {
+        bool ok = safety.checkPosition({soa[i], soa[count + i], soa[2 * count + i]});
+        bool failed = (mask[i / 64] >> (i % 64)) & 1u;
+        REQUIRE(failed == !ok);
+        if (!ok && expectedFirst == count) expectedFirst = i;
+    }
+    REQUIRE((mask[500 / 64] >> (500 % 64)) & 1u);
+    REQUIRE(first == expectedFirst);
+    // Without a mask the scan stops at the first failure
+    REQUIRE(safety.checkPositionsBatch(soa.data(), count, 3) == expectedFirst);
+}
+
+TEST_CASE("SafetyMonitor batch check passes, stops and rejects under e-stop", "[SafetyMonitor]") {
+    SafetyMonitor safety(2);
+    safety.setAxisBounds(0, 0.0, 10.0);
+    safety.setAxisBounds(1, 0.0, 10.0);
+    // Axis-major: X values then Y values; a third axis beyond the configured bounds is ignored
+    std::vector<double> soa = {1, 2, 3, 4, 5, 6, 7,
+                               1, 2, 3, 4, 5, 6, 7,
+                               1e9, 1e9, 1e9, 1e9, 1e9, 1e9, 1e9};
+    std::uint64_t mask = ~std::uint64_t(0);
+    REQUIRE(safety.checkPositionsBatch(soa.data(), 7, 3, &mask) == 7);
+    REQUIRE(mask == 0);
+    soa[7 + 5] = 11.0; // point 5, Y
+    REQUIRE(safety.checkPositionsBatch(soa.data(), 7, 3, &mask) == 5);
+    REQUIRE(mask == (std::uint64_t(1) << 5));
+    REQUIRE(safety.checkPositionsBatch(soa.data(), 0, 3) == 0);
+
+    KeepOutZones zones;
+    const double lo[3] = {2.5, 2.5, -1.0};
+    const double hi[3] = {3.5, 3.5, 1.0};
+    zones.addBox(lo, hi);
+    safety.setKeepOutZones(&zones);
+    REQUIRE(safety.checkPositionsBatch(soa.data(), 7, 2, &mask) == 2);
+    REQUIRE(mask == ((std::uint64_t(1) << 5) | (std::uint64_t(1) << 2)));
+
+    safety.triggerEStop(SafetyMonitor::StopReason::Operator);
+    REQUIRE(safety.checkPositionsBatch(soa.data(), 7, 2, &mask) == 0);
+    REQUIRE(mask == 0x7F);
+}
+
+TEST_CASE("SafetyMonitor batch check benchmark", "[.][benchmark][SafetyMonitor]") {
+    SafetyMonitor safety(3);
+    safety.setAxisBounds(0, -1000.0, 1000.0);
+    safety.setAxisBounds(1, -1000.0, 1000.0);
+    safety.setAxisBounds(2, -50.0, 50.0);
+    const std::size_t count = 1000000;
+    std::vector<double> soa(3 * count);
+    for (std::size_t i = 0; i < count; ++i) {
+        soa[i] = static_cast<double>(i % 2000) - 1000.0;
+        soa[count + i] = static_cast<double>((i / 2000) % 2000) - 1000.0;
+        soa[2 * count + i] = 0.0;
+    }
+    std::vector<std::uint64_t> mask((count + 63) / 64);
+    auto start = std::chrono::steady_clock::now();
+    std::size_t first = safety.checkPositionsBatch(soa.data(), count, 3, mask.data());
+    auto batch = std::chrono::steady_clock::now() - start;
+    REQUIRE(first == count);
+    start = std::chrono::steady_clock::now();
+    std::size_t passed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (safety.checkPosition({soa[i], soa[count + i], soa[2 * count + i]})) ++passed;
+    }
+    auto perPoint = std::chrono::steady_clock::now() - start;
+    REQUIRE(passed == count);
+    std::cout << "SafetyMonitor: 1M x 3-axis raster: batch "
+              << std::chrono::duration_cast<std::chrono::microseconds>(batch).count() << " us, per point "
+              << std::chrono::duration_cast<std::chrono::microseconds>(perPoint).count() << " us\n";
+}
+
+TEST_CASE("SafetyMonitor kinematic limits and move profiles", "[SafetyMonitor]") {
+    SafetyMonitor safety(2);
+    SafetyMonitor::KinematicLimits limits;
+    limits.velocity = 100.0;
+    limits.acceleration = 1000.0;
+    limits.deceleration = 500.0;
+    limits.jerk = 1e4;
+    REQUIRE(safety.setAxisLimits(1, limits));
+    REQUIRE(safety.getAxisLimits(1).deceleration == 500.0);
+    REQUIRE(std::isinf(safety.getAxisLimits(0).velocity)); // unlimited by default
+    REQUIRE_FALSE(safety.setAxisLimits(2, limits));
+    SafetyMonitor::KinematicLimits bad = limits;
+    bad.jerk = 0.0;
+    REQUIRE_FALSE(safety.setAxisLimits(0, bad));
+    bad.jerk = std::nan("");
+    REQUIRE_FALSE(safety.setVectorLimits(bad));
+    REQUIRE(safety.setVectorLimits(limits));
+
+    // A recipe asking for more than the envelope allows
+    SafetyMonitor::KinematicLimits profile;
+    profile.velocity = 250.0;
+    profile.acceleration = 800.0;
+    profile.deceleration = 800.0;
+    profile.jerk = 5000.0;
+    SafetyMonitor::KinematicLimits rejected = profile;
+    REQUIRE_FALSE(safety.limitMoveProfile(rejected, SafetyMonitor::LimitMode::Reject));
+    REQUIRE(rejected.velocity == 250.0);
+    REQUIRE(safety.limitMoveProfile(profile, SafetyMonitor::LimitMode::Clamp));
+    REQUIRE(profile.velocity == 100.0);
+    REQUIRE(profile.acceleration == 800.0);
+    REQUIRE(profile.deceleration == 500.0);
+    REQUIRE(profile.jerk == 5000.0);
+    REQUIRE(safety.limitMoveProfile(profile, SafetyMonitor::LimitMode::Reject));
+    profile.acceleration = -1.0;
+    REQUIRE_FALSE(safety.limitMoveProfile(profile, SafetyMonitor::LimitMode::Clamp));
+}
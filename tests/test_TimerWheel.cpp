@@ -0,0 +1,63 @@
+#include "catch.hpp"
+#include "TimerWheel.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST_CASE("TimerWheel fires timers after their delay", "[TimerWheel]") {
+    using namespace std::chrono;
+    std::mutex mtx;
+    std::vector<std::pair<int, steady_clock::time_point>> fired;
+    TimerWheel wheel([&](int id, std::uint64_t tag) {
+        std::lock_guard<std::mutex> lock(mtx);
+        fired.emplace_back(id * 100 + static_cast<int>(tag), steady_clock::now());
+    }, microseconds(500), 16);
+    auto start = steady_clock::now();
+    wheel.schedule(milliseconds(20), 2, 1);
+    wheel.schedule(milliseconds(5), 1, 7);
+    wheel.schedule(milliseconds(30), 3, 0); // longer than one turn of the 16-slot wheel
+    REQUIRE(wheel.pendingCount() == 3);
+    while (wheel.pendingCount() > 0) std::this_thread::sleep_for(milliseconds(1));
+    std::lock_guard<std::mutex> lock(mtx);
+    REQUIRE(fired.size() == 3);
+    REQUIRE(fired[0].first == 107);
+    REQUIRE(fired[1].first == 201);
+    REQUIRE(fired[2].first == 300);
+    REQUIRE(fired[0].second - start >= milliseconds(5));
+    REQUIRE(fired[1].second - start >= milliseconds(20));
+    REQUIRE(fired[2].second - start >= milliseconds(30));
+}
+
+TEST_CASE("TimerWheel handles many timers from several threads", "[TimerWheel]") {
+    using namespace std::chrono;
+    std::atomic<int> count(0);
+    {
+        TimerWheel wheel([&](int, std::uint64_t) { count.fetch_add(1); });
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&wheel, t]() {
+                for (int i = 0; i < 500; ++i) wheel.schedule(microseconds(100 * (i % 50)), t, i);
+            });
+        }
+        for (auto& th : threads) th.join();
+        while (wheel.pendingCount() > 0) std::this_thread::sleep_for(milliseconds(1));
+    }
+    REQUIRE(count.load() == 2000);
+}
+
+TEST_CASE("TimerWheel does not skip a timer when the idle worker wakes late", "[TimerWheel]") {
+    using namespace std::chrono;
+    // With a 1 us tick, any wake-up latency leaves the idle worker past the timer's due tick
+    std::atomic<bool> fired(false);
+    TimerWheel wheel([&](int, std::uint64_t) { fired.store(true); }, microseconds(1), 100000);
+    for (int i = 0; i < 5; ++i) {
+        std::this_thread::sleep_for(milliseconds(1)); // let the worker go idle
+        fired.store(false);
+        auto start = steady_clock::now();
+        wheel.schedule(microseconds(1), i, 0);
+        while (!fired.load()) std::this_thread::sleep_for(microseconds(50));
+        // One full turn of the wheel is 100 ms
+        REQUIRE(steady_clock::now() - start < milliseconds(50));
+    }
+}
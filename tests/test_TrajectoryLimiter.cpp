@@ -0,0 +1,215 @@
+#include "catch.hpp"
+#include "TrajectoryLimiter.h"
+#include "SafetyMonitor.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+SafetyMonitor::KinematicLimits velocityLimit(double v) {
+    SafetyMonitor::KinematicLimits limits;
+    limits.velocity = v;
+    return limits;
+}
+} // namespace
+
+TEST_CASE("TrajectoryLimiter clamps steps to the axis velocity limit", "[TrajectoryLimiter]") {
+    SafetyMonitor safety(1);
+    REQUIRE(safety.setAxisLimits(0, velocityLimit(10.0)));
+    TrajectoryLimiter limiter(safety, 1, 0.01);
+    double point = 1.0;
+    REQUIRE(limiter.process(&point) == TrajectoryLimiter::Result::Clamped);
+    REQUIRE(point == Approx(0.1));
+    // Keep commanding the same target: the output catches up at the limit speed
+    double previous = point;
+    int steps = 1;
+    TrajectoryLimiter::Result result = TrajectoryLimiter::Result::Clamped;
+    while (result != TrajectoryLimiter::Result::Accepted && steps < 20) {
+        point = 1.0;
+        result = limiter.process(&point);
+        REQUIRE((point - previous) / 0.01 <= 10.0 + 1e-6);
+        previous = point;
+        ++steps;
+    }
+    REQUIRE(point == Approx(1.0));
+    REQUIRE(steps <= 11);
+    REQUIRE(limiter.clampedCount() >= 9);
+}
+
+TEST_CASE("TrajectoryLimiter reject mode refuses a point and keeps its state", "[TrajectoryLimiter]") {
+    SafetyMonitor safety(1);
+    safety.setAxisLimits(0, velocityLimit(10.0));
+    TrajectoryLimiter limiter(safety, 1, 0.01, SafetyMonitor::LimitMode::Reject);
+    double point = 1.0;
+    REQUIRE(limiter.process(&point) == TrajectoryLimiter::Result::Rejected);
+    REQUIRE(point == 1.0);
+    REQUIRE(limiter.getPosition()[0] == 0.0);
+    point = 0.05;
+    REQUIRE(limiter.process(&point) == TrajectoryLimiter::Result::Accepted);
+    REQUIRE(limiter.getPosition()[0] == 0.05);
+    REQUIRE(limiter.rejectedCount() == 1);
+    // A non-finite command is refused in either mode
+    point = std::nan("");
+    REQUIRE(limiter.process(&point) == TrajectoryLimiter::Result::Rejected);
+}
+
+TEST_CASE("TrajectoryLimiter keeps the direction of a coordinated step", "[TrajectoryLimiter]") {
+    SafetyMonitor safety(2);
+    safety.setAxisLimits(0, velocityLimit(10.0));
+    TrajectoryLimiter limiter(safety, 2, 0.01);
+    double point[2] = {1.0, 2.0};
+    REQUIRE(limiter.process(point) == TrajectoryLimiter::Result::Clamped);
+    REQUIRE(point[0] == Approx(0.1));
+    REQUIRE(point[1] == Approx(0.2));
+
+    // Path speed limit on the vector length of the step
+    REQUIRE(safety.setAxisLimits(0, SafetyMonitor::KinematicLimits()));
+    REQUIRE(safety.setVectorLimits(velocityLimit(5.0)));
+    TrajectoryLimiter pathLimiter(safety, 2, 0.1);
+    double diagonal[2] = {3.0, 4.0};
+    REQUIRE(pathLimiter.process(diagonal) == TrajectoryLimiter::Result::Clamped);
+    REQUIRE(diagonal[0] == Approx(0.3));
+    REQUIRE(diagonal[1] == Approx(0.4));
+}
+
+TEST_CASE("TrajectoryLimiter limits acceleration and jerk from rest", "[TrajectoryLimiter]") {
+    SafetyMonitor safety(2);
+    SafetyMonitor::KinematicLimits accelOnly;
+    accelOnly.acceleration = 100.0;
+    SafetyMonitor::KinematicLimits jerkOnly;
+    jerkOnly.jerk = 1000.0;
+    safety.setAxisLimits(0, accelOnly);
+    safety.setAxisLimits(1, jerkOnly);
+    TrajectoryLimiter accelLimiter(safety, 1, 0.01);
+    double x = 10.0;
+    accelLimiter.process(&x);
+    REQUIRE(x == Approx(0.01)); // v <= 100 * 0.01 = 1
+    x = 10.0;
+    accelLimiter.process(&x);
+    REQUIRE(x == Approx(0.03)); // v <= 2
+
+    // Axis 1 only: a <= 1000 * 0.01 = 10, so v <= 0.1 and the first step is 0.001
+    const double start[2] = {0.0, 0.0};
+    TrajectoryLimiter jerkLimiter(safety, 2, 0.01);
+    jerkLimiter.reset(start);
+    double p[2] = {0.0, 10.0};
+    jerkLimiter.process(p);
+    REQUIRE(p[1] == Approx(0.001));
+}
+
+TEST_CASE("TrajectoryLimiter applies the deceleration limit to a reversal", "[TrajectoryLimiter]") {
+    SafetyMonitor safety(1);
+    SafetyMonitor::KinematicLimits limits;
+    limits.acceleration = 1e6;
+    limits.deceleration = 100.0;
+    REQUIRE(safety.setAxisLimits(0, limits));
+    TrajectoryLimiter limiter(safety, 1, 0.01, SafetyMonitor::LimitMode::Reject);
+    double x = 0.1;
+    REQUIRE(limiter.process(&x) == TrajectoryLimiter::Result::Accepted); // v = 10
+    // Stepping back to 0.099 gives v = -0.1: a = -1010 brakes the forward motion
+    x = 0.099;
+    REQUIRE(limiter.process(&x) == TrajectoryLimiter::Result::Rejected);
+    // Slowing down while still moving forward is within the deceleration limit (a = -10)
+    x = 0.199;
+    REQUIRE(limiter.process(&x) == TrajectoryLimiter::Result::Accepted);
+
+    // Mirrored: moving in the negative direction, a positive step is a reversal too
+    const double start = 0.0;
+    limiter.reset(&start);
+    x = -0.1;
+    REQUIRE(limiter.process(&x) == TrajectoryLimiter::Result::Accepted);
+    x = -0.099;
+    REQUIRE(limiter.process(&x) == TrajectoryLimiter::Result::Rejected);
+    x = -0.199;
+    REQUIRE(limiter.process(&x) == TrajectoryLimiter::Result::Accepted);
+}
+
+TEST_CASE("TrajectoryLimiter validate finds the first point outside the envelope", "[TrajectoryLimiter]") {
+    SafetyMonitor safety(1);
+    SafetyMonitor::KinematicLimits limits;
+    limits.velocity = 10.0;
+    limits.acceleration = 100.0;
+    limits.deceleration = 50.0;
+    safety.setAxisLimits(0, limits);
+    TrajectoryLimiter limiter(safety, 1, 0.01);
+    // Ramp up at the acceleration limit (1 unit/s per period) to 10 units/s, cruise, then stop dead
+    std::vector<double> points = {5.0};
+    for (int v = 1; v <= 10; ++v) points.push_back(points.back() + v * 0.01);
+    for (int k = 0; k < 5; ++k) points.push_back(points.back() + 0.1);
+    const std::size_t stopIndex = points.size();
+    points.push_back(points.back());
+    REQUIRE(limiter.validate(points.data(), stopIndex) == stopIndex);
+    REQUIRE(limiter.validate(points.data(), points.size()) == stopIndex);
+    REQUIRE(limiter.getPosition()[0] == Approx(points[stopIndex - 1]));
+    // A jump during the ramp breaks the acceleration limit
+    std::vector<double> jumpy = points;
+    jumpy[3] += 0.05;
+    REQUIRE(limiter.validate(jumpy.data(), jumpy.size()) == 3);
+
+    // Clamp mode cannot overshoot the command to brake, so the stop is passed through and counted
+    TrajectoryLimiter clampLimiter(safety, 1, 0.01);
+    clampLimiter.reset(&points[0]);
+    for (std::size_t k = 1; k < points.size(); ++k) {
+        double p = points[k];
+        clampLimiter.process(&p);
+        REQUIRE(p == Approx(points[k]));
+    }
+    REQUIRE(clampLimiter.clampedCount() == 1);
+}
+
+TEST_CASE("TrajectoryLimiter output never exceeds velocity limits", "[TrajectoryLimiter]") {
+    SafetyMonitor safety(3);
+    SafetyMonitor::KinematicLimits limits;
+    limits.velocity = 50.0;
+    limits.acceleration = 2000.0;
+    limits.deceleration = 2000.0;
+    limits.jerk = 1e5;
+    for (int a = 0; a < 3; ++a) REQUIRE(safety.setAxisLimits(a, limits));
+    REQUIRE(safety.setVectorLimits(velocityLimit(60.0)));
+    const double period = 0.001;
+    TrajectoryLimiter limiter(safety, 3, period);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> jump(-1.0, 1.0);
+    double command[3] = {0.0, 0.0, 0.0};
+    double previous[3] = {0.0, 0.0, 0.0};
+    for (int k = 0; k < 5000; ++k) {
+        for (double& c : command) c += jump(rng);
+        double out[3] = {command[0], command[1], command[2]};
+        limiter.process(out);
+        double speed2 = 0.0;
+        for (int a = 0; a < 3; ++a) {
+            double v = (out[a] - previous[a]) / period;
+            REQUIRE(std::fabs(v) <= 50.0 * (1.0 + 1e-9));
+            speed2 += v * v;
+            previous[a] = out[a];
+        }
+        REQUIRE(std::sqrt(speed2) <= 60.0 * (1.0 + 1e-9));
+    }
+}
+
+TEST_CASE("TrajectoryLimiter streaming benchmark", "[.][benchmark][TrajectoryLimiter]") {
+    SafetyMonitor safety(4);
+    SafetyMonitor::KinematicLimits limits;
+    limits.velocity = 100.0;
+    limits.acceleration = 1000.0;
+    limits.deceleration = 1000.0;
+    limits.jerk = 1e5;
+    for (int a = 0; a < 4; ++a) safety.setAxisLimits(a, limits);
+    TrajectoryLimiter limiter(safety, 4, 0.001);
+    const std::size_t count = 1000000;
+    std::size_t accepted = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t k = 0; k < count; ++k) {
+        double t = static_cast<double>(k) * 0.001;
+        // Starts at rest and stays inside the envelope, so every point is checked and passed
+        double point[4] = {10.0 * (1.0 - std::cos(t)), 5.0 * (1.0 - std::cos(t)), 2.0 * (1.0 - std::cos(0.5 * t)), 0.0};
+        if (limiter.process(point) == TrajectoryLimiter::Result::Accepted) ++accepted;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(accepted == count);
+    std::cout << "TrajectoryLimiter: " << count << " 4-axis points in "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << " us ("
+              << accepted << " unchanged)\n";
+}
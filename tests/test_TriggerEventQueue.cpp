@@ -0,0 +1,57 @@
+#include "catch.hpp"
+#include "TriggerEventQueue.h"
+#include <thread>
+#include <vector>
+
+TEST_CASE("TriggerEventQueue preserves order and drops when full", "[TriggerEventQueue]") {
+    TriggerEventQueue queue(4);
+    REQUIRE(queue.capacity() == 4);
+    for (int i = 0; i < 6; ++i) {
+        TriggerEvent e{static_cast<std::uint64_t>(i), i, TriggerEvent::Edge::Rising};
+        queue.push(e);
+    }
+    REQUIRE(queue.size() == 4);
+    REQUIRE(queue.droppedCount() == 2);
+    TriggerEvent out[8];
+    REQUIRE(queue.popBatch(out, 3) == 3);
+    REQUIRE(out[0].triggerId == 0);
+    REQUIRE(out[2].triggerId == 2);
+    REQUIRE(queue.popBatch(out, 8) == 1);
+    REQUIRE(out[0].triggerId == 3);
+    REQUIRE(queue.popBatch(out, 8) == 0);
+    // Space is reusable after draining
+    REQUIRE(queue.push(TriggerEvent{9, 9, TriggerEvent::Edge::Falling}));
+    REQUIRE(queue.popBatch(out, 8) == 1);
+    REQUIRE(out[0].edge == TriggerEvent::Edge::Falling);
+}
+
+TEST_CASE("TriggerEventQueue multiple producers lose nothing", "[TriggerEventQueue]") {
+    const int producers = 4;
+    const int perProducer = 20000;
+    TriggerEventQueue queue(1024);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p]() {
+            for (int i = 0; i < perProducer; ++i) {
+                TriggerEvent e{static_cast<std::uint64_t>(i), p, TriggerEvent::Edge::Rising};
+                while (!queue.push(e)) std::this_thread::yield();
+            }
+        });
+    }
+    // Each producer's events must arrive in its own order
+    std::vector<std::uint64_t> next(producers, 0);
+    TriggerEvent batch[64];
+    int received = 0;
+    bool ordered = true;
+    while (received < producers * perProducer) {
+        std::size_t n = queue.popBatch(batch, 64);
+        if (n == 0) std::this_thread::yield();
+        for (std::size_t i = 0; i < n; ++i) {
+            if (batch[i].timestampNs != next[batch[i].triggerId]++) ordered = false;
+        }
+        received += static_cast<int>(n);
+    }
+    for (auto& t : threads) t.join();
+    REQUIRE(ordered);
+    REQUIRE(queue.size() == 0);
+}
@@ -1,7 +1,10 @@
 #include "catch.hpp"
 #include "TriggerHandler.h"
+#include <atomic>
 #include <thread>
 #include <chrono>
+#include <iostream>
+#include <vector>
 
 TEST_CASE("TriggerHandler initial state and set/clear", "[TriggerHandler]") {
     TriggerHandler triggers;
@@ -33,3 +36,428 @@ TEST_CASE("TriggerHandler waitForTrigger unblocks on trigger", "[TriggerHandler]
     REQUIRE(signaled == true);
     REQUIRE(triggers.isTriggered(TRIG_CAPTURE) == true);
 }
+
+TEST_CASE("TriggerHandler dense and sparse ids are independent", "[TriggerHandler]") {
+    TriggerHandler triggers;
+    const int lastDense = TriggerHandler::kDenseTriggers - 1;
+    const int sparse = 100000;
+    triggers.setTrigger(63, true);
+    triggers.setTrigger(64, true);
+    triggers.setTrigger(lastDense, true);
+    triggers.setTrigger(sparse, true);
+    triggers.setTrigger(-5, true);
+    REQUIRE(triggers.isTriggered(63));
+    REQUIRE(triggers.isTriggered(64));
+    REQUIRE(triggers.isTriggered(lastDense));
+    REQUIRE(triggers.isTriggered(sparse));
+    REQUIRE(triggers.isTriggered(-5));
+    REQUIRE_FALSE(triggers.isTriggered(62));
+    REQUIRE_FALSE(triggers.isTriggered(65));
+    REQUIRE_FALSE(triggers.isTriggered(sparse + 1));
+    triggers.clearTrigger(64);
+    triggers.clearTrigger(sparse);
+    REQUIRE(triggers.isTriggered(63));
+    REQUIRE_FALSE(triggers.isTriggered(64));
+    REQUIRE_FALSE(triggers.isTriggered(sparse));
+}
+
+TEST_CASE("TriggerHandler waitForTrigger unblocks on a sparse trigger", "[TriggerHandler]") {
+    TriggerHandler triggers;
+    std::thread t([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        triggers.setTrigger(5000, true);
+    });
+    triggers.waitForTrigger(5000);
+    t.join();
+    REQUIRE(triggers.isTriggered(5000));
+}
+
+TEST_CASE("TriggerHandler concurrent set/clear keeps neighbouring bits", "[TriggerHandler]") {
+    // Threads toggle different bits of the same word; no update may be lost
+    TriggerHandler triggers;
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 8; ++id) {
+        threads.emplace_back([&triggers, id]() {
+            for (int i = 0; i < 10000; ++i) {
+                triggers.setTrigger(id, true);
+                triggers.clearTrigger(id);
+            }
+            if (id % 2 == 0) triggers.setTrigger(id, true);
+        });
+    }
+    for (auto& t : threads) t.join();
+    for (int id = 0; id < 8; ++id) {
+        REQUIRE(triggers.isTriggered(id) == (id % 2 == 0));
+    }
+}
+
+TEST_CASE("TriggerHandler wakes only the waiters of the set trigger", "[TriggerHandler]") {
+    TriggerHandler triggers;
+    std::atomic<int> startWoken(0), stopWoken(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; ++i) {
+        threads.emplace_back([&]() { triggers.waitForTrigger(TRIG_START); startWoken.fetch_add(1); });
+        threads.emplace_back([&]() { triggers.waitForTrigger(TRIG_STOP); stopWoken.fetch_add(1); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    triggers.setTrigger(TRIG_START, true);
+    while (startWoken.load() != 3) std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(stopWoken.load() == 0);
+    triggers.setTrigger(TRIG_STOP, true);
+    for (auto& t : threads) t.join();
+    REQUIRE(stopWoken.load() == 3);
+}
+
+TEST_CASE("TriggerHandler waitFor times out or returns on trigger", "[TriggerHandler]") {
+    using namespace std::chrono;
+    TriggerHandler triggers;
+    auto start = steady_clock::now();
+    REQUIRE_FALSE(triggers.waitFor(TRIG_CAPTURE, milliseconds(30)));
+    REQUIRE(steady_clock::now() - start >= milliseconds(30));
+    REQUIRE_FALSE(triggers.waitFor(7000, milliseconds(5))); // sparse id
+    std::thread t([&]() {
+        std::this_thread::sleep_for(milliseconds(10));
+        triggers.setTrigger(TRIG_CAPTURE, true);
+    });
+    REQUIRE(triggers.waitFor(TRIG_CAPTURE, seconds(5)));
+    t.join();
+    // Already active: returns immediately even with a zero timeout
+    REQUIRE(triggers.waitFor(TRIG_CAPTURE, milliseconds(0)));
+}
+
+TEST_CASE("TriggerHandler timed waits with huge timeouts do not expire at once", "[TriggerHandler]") {
+    using namespace std::chrono;
+    TriggerHandler triggers;
+    std::thread t([&]() {
+        std::this_thread::sleep_for(milliseconds(20));
+        triggers.setTrigger(TRIG_START, true);
+        std::this_thread::sleep_for(milliseconds(20));
+        triggers.setTrigger(TRIG_STOP, true);
+        std::this_thread::sleep_for(milliseconds(20));
+        triggers.setTrigger(9000, true);
+    });
+    REQUIRE(triggers.waitFor(TRIG_START, TriggerHandler::Duration::max()));
+    REQUIRE(triggers.waitAny({TRIG_STOP}, TriggerHandler::Duration::max() - seconds(1)) == TRIG_STOP);
+    REQUIRE(triggers.waitAll({TRIG_START, TRIG_STOP, 9000}, TriggerHandler::Duration::max()));
+    t.join();
+}
+
+TEST_CASE("TriggerHandler waitAny returns the trigger that fired", "[TriggerHandler]") {
+    using namespace std::chrono;
+    TriggerHandler triggers;
+    REQUIRE(triggers.waitAny({TRIG_START, TRIG_STOP}, milliseconds(10)) == TriggerHandler::kTimedOut);
+    std::thread t([&]() {
+        std::this_thread::sleep_for(milliseconds(10));
+        triggers.setTrigger(9000, true);
+    });
+    REQUIRE(triggers.waitAny({TRIG_START, TRIG_STOP, 9000}, seconds(5)) == 9000);
+    t.join();
+    triggers.setTrigger(TRIG_STOP, true);
+    REQUIRE(triggers.waitAny({TRIG_START, TRIG_STOP}, milliseconds(0)) == TRIG_STOP);
+}
+
+TEST_CASE("TriggerHandler waitAll needs every trigger active", "[TriggerHandler]") {
+    using namespace std::chrono;
+    TriggerHandler triggers;
+    triggers.setTrigger(TRIG_START, true);
+    REQUIRE_FALSE(triggers.waitAll({TRIG_START, TRIG_STOP}, milliseconds(10)));
+    std::thread t([&]() {
+        std::this_thread::sleep_for(milliseconds(5));
+        triggers.setTrigger(TRIG_STOP, true);
+        std::this_thread::sleep_for(milliseconds(5));
+        triggers.setTrigger(TRIG_CAPTURE, true);
+    });
+    REQUIRE(triggers.waitAll({TRIG_START, TRIG_STOP, TRIG_CAPTURE}, seconds(5)));
+    t.join();
+    // Many ids exceed the inline registration nodes
+    std::vector<int> ids;
+    for (int id = 100; id < 120; ++id) {
+        triggers.setTrigger(id, true);
+        ids.push_back(id);
+    }
+    REQUIRE(triggers.waitAll(ids, milliseconds(0)));
+    triggers.clearTrigger(119);
+    REQUIRE_FALSE(triggers.waitAll(ids, milliseconds(5)));
+}
+
+TEST_CASE("TriggerHandler counts every rising edge", "[TriggerHandler]") {
+    TriggerHandler triggers;
+    // Two quick pulses between polls are both counted
+    for (int pulse = 0; pulse < 2; ++pulse) {
+        triggers.setTrigger(TRIG_CAPTURE, true);
+        triggers.clearTrigger(TRIG_CAPTURE);
+    }
+    REQUIRE_FALSE(triggers.isTriggered(TRIG_CAPTURE));
+    REQUIRE(triggers.getEdgeCount(TRIG_CAPTURE) == 2);
+    // Re-setting an active trigger is not an edge
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    REQUIRE(triggers.getEdgeCount(TRIG_CAPTURE) == 3);
+    triggers.setTrigger(50000, true);
+    triggers.setTrigger(50000, false);
+    triggers.setTrigger(50000, true);
+    REQUIRE(triggers.getEdgeCount(50000) == 2);
+    REQUIRE(triggers.getEdgeCount(TRIG_START) == 0);
+}
+
+TEST_CASE("TriggerHandler streams timestamped edges to an event queue", "[TriggerHandler]") {
+    TriggerHandler triggers;
+    TriggerEventQueue queue(64);
+    triggers.setEventQueue(&queue);
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    triggers.setTrigger(TRIG_CAPTURE, true); // no edge
+    triggers.clearTrigger(TRIG_CAPTURE);
+    triggers.setTrigger(7000, true);
+    triggers.setEventQueue(nullptr);
+    triggers.setTrigger(TRIG_START, true); // not streamed
+    TriggerEvent events[8];
+    REQUIRE(queue.popBatch(events, 8) == 3);
+    REQUIRE(events[0].triggerId == TRIG_CAPTURE);
+    REQUIRE(events[0].edge == TriggerEvent::Edge::Rising);
+    REQUIRE(events[1].triggerId == TRIG_CAPTURE);
+    REQUIRE(events[1].edge == TriggerEvent::Edge::Falling);
+    REQUIRE(events[2].triggerId == 7000);
+    REQUIRE(events[0].timestampNs <= events[1].timestampNs);
+    REQUIRE(events[1].timestampNs <= events[2].timestampNs);
+}
+
+TEST_CASE("TriggerHandler sample debounce ignores short glitches", "[TriggerHandler]") {
+    TriggerHandler triggers;
+    triggers.setDebounceSamples(TRIG_CAPTURE, 3);
+    // Bounces shorter than three samples never reach the trigger
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    triggers.setTrigger(TRIG_CAPTURE, false);
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    REQUIRE_FALSE(triggers.isTriggered(TRIG_CAPTURE));
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    REQUIRE(triggers.isTriggered(TRIG_CAPTURE));
+    triggers.setTrigger(TRIG_CAPTURE, false);
+    REQUIRE(triggers.isTriggered(TRIG_CAPTURE));
+    REQUIRE(triggers.getEdgeCount(TRIG_CAPTURE) == 1);
+    // Without the filter every sample applies again
+    triggers.clearDebounce(TRIG_CAPTURE);
+    triggers.setTrigger(TRIG_CAPTURE, false);
+    REQUIRE_FALSE(triggers.isTriggered(TRIG_CAPTURE));
+}
+
+TEST_CASE("TriggerHandler time debounce commits stable levels only", "[TriggerHandler]") {
+    using namespace std::chrono;
+    TriggerHandler triggers;
+    triggers.setDebounceTime(TRIG_START, milliseconds(20));
+    triggers.setDebounceTime(90000, milliseconds(5)); // sparse ids are filtered too
+    // A 1 ms glitch is suppressed
+    triggers.setTrigger(TRIG_START, true);
+    std::this_thread::sleep_for(milliseconds(1));
+    triggers.setTrigger(TRIG_START, false);
+    std::this_thread::sleep_for(milliseconds(40));
+    REQUIRE_FALSE(triggers.isTriggered(TRIG_START));
+    REQUIRE(triggers.getEdgeCount(TRIG_START) == 0);
+    // A level that holds is applied after the stable time and wakes waiters once
+    auto start = steady_clock::now();
+    triggers.setTrigger(TRIG_START, true);
+    REQUIRE_FALSE(triggers.isTriggered(TRIG_START));
+    REQUIRE(triggers.waitFor(TRIG_START, seconds(5)));
+    REQUIRE(steady_clock::now() - start >= milliseconds(20));
+    REQUIRE(triggers.getEdgeCount(TRIG_START) == 1);
+    triggers.setTrigger(90000, true);
+    REQUIRE(triggers.waitFor(90000, seconds(5)));
+    // Undebounced triggers are unaffected
+    triggers.setTrigger(TRIG_STOP, true);
+    REQUIRE(triggers.isTriggered(TRIG_STOP));
+}
+
+TEST_CASE("TriggerHandler clearTrigger bypasses the debounce filter", "[TriggerHandler]") {
+    using namespace std::chrono;
+    TriggerHandler triggers;
+    triggers.setDebounceSamples(TRIG_CAPTURE, 3);
+    for (int i = 0; i < 3; ++i) triggers.setTrigger(TRIG_CAPTURE, true);
+    REQUIRE(triggers.isTriggered(TRIG_CAPTURE));
+    triggers.clearTrigger(TRIG_CAPTURE);
+    REQUIRE_FALSE(triggers.isTriggered(TRIG_CAPTURE));
+    // The filter restarts from the inactive level: a new activation needs three samples again
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    REQUIRE_FALSE(triggers.isTriggered(TRIG_CAPTURE));
+    triggers.setTrigger(TRIG_CAPTURE, true);
+    REQUIRE(triggers.isTriggered(TRIG_CAPTURE));
+    REQUIRE(triggers.getEdgeCount(TRIG_CAPTURE) == 2);
+
+    // Time filter: the clear applies at once and cancels a pending commit of the active level
+    triggers.setDebounceTime(TRIG_START, milliseconds(20));
+    triggers.setDebounceTime(90000, milliseconds(20));
+    triggers.setTrigger(TRIG_START, true);
+    triggers.setTrigger(90000, true);
+    REQUIRE(triggers.waitFor(TRIG_START, seconds(5)));
+    REQUIRE(triggers.waitFor(90000, seconds(5)));
+    triggers.clearTrigger(TRIG_START);
+    triggers.clearTrigger(90000);
+    REQUIRE_FALSE(triggers.isTriggered(TRIG_START));
+    REQUIRE_FALSE(triggers.isTriggered(90000));
+    triggers.setTrigger(TRIG_START, true);
+    triggers.clearTrigger(TRIG_START);
+    std::this_thread::sleep_for(milliseconds(40));
+    REQUIRE_FALSE(triggers.isTriggered(TRIG_START));
+    REQUIRE(triggers.getEdgeCount(TRIG_START) == 1);
+}
+
+TEST_CASE("TriggerHandler debounced state follows the last commit under racing clears", "[TriggerHandler]") {
+    TriggerHandler triggers;
+    triggers.setDebounceSamples(TRIG_CAPTURE, 1);
+    for (int round = 0; round < 20; ++round) {
+        std::atomic<bool> go{false};
+        std::thread setter([&] {
+            while (!go.load()) std::this_thread::yield();
+            for (int i = 0; i < 500; ++i) {
+                triggers.setTrigger(TRIG_CAPTURE, true);
+                triggers.setTrigger(TRIG_CAPTURE, false);
+            }
+            triggers.setTrigger(TRIG_CAPTURE, true);
+        });
+        std::thread clearer([&] {
+            while (!go.load()) std::this_thread::yield();
+            for (int i = 0; i < 500; ++i) triggers.clearTrigger(TRIG_CAPTURE);
+        });
+        go.store(true);
+        setter.join();
+        clearer.join();
+        // Whatever won, the applied state matches the filter: the next samples take effect
+        triggers.setTrigger(TRIG_CAPTURE, false);
+        REQUIRE_FALSE(triggers.isTriggered(TRIG_CAPTURE));
+        triggers.setTrigger(TRIG_CAPTURE, true);
+        REQUIRE(triggers.isTriggered(TRIG_CAPTURE));
+    }
+}
+
+TEST_CASE("TriggerHandler polling contention benchmark", "[.][benchmark][TriggerHandler]") {
+    // Many threads poll while one thread toggles; compare the dense bitset with the map fallback
+    const int pollers = 8;
+    const auto duration = std::chrono::milliseconds(300);
+    for (int id : {TRIG_CAPTURE, 100000}) {
+        TriggerHandler triggers;
+        std::atomic<bool> done(false);
+        std::atomic<long long> polls(0), seen(0);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < pollers; ++p) {
+            threads.emplace_back([&]() {
+                long long local = 0, active = 0;
+                while (!done.load(std::memory_order_relaxed)) {
+                    active += triggers.isTriggered(id) ? 1 : 0;
+                    ++local;
+                }
+                polls.fetch_add(local);
+                seen.fetch_add(active);
+            });
+        }
+        threads.emplace_back([&]() {
+            bool state = false;
+            while (!done.load(std::memory_order_relaxed)) {
+                state = !state;
+                triggers.setTrigger(id, state);
+            }
+        });
+        std::this_thread::sleep_for(duration);
+        done.store(true);
+        for (auto& t : threads) t.join();
+        double seconds = std::chrono::duration<double>(duration).count();
+        std::cout << (id == TRIG_CAPTURE ? "dense" : "sparse") << " trigger, " << pollers
+                  << " pollers: " << polls.load() / seconds / 1e6 << " M polls/s (active "
+                  << seen.load() << ")" << std::endl;
+        REQUIRE(polls.load() > 0);
+    }
+}
+
+TEST_CASE("TriggerHandler set-to-wake latency benchmark", "[.][benchmark][TriggerHandler]") {
+    // 16 threads each wait on their own trigger; setting one trigger should wake only its waiter
+    const int waiterCount = 16;
+    const int rounds = 2000;
+    const int firstId = 10;
+    TriggerHandler triggers;
+    std::atomic<bool> done(false);
+    std::atomic<long long> setTime(0), totalLatencyNs(0);
+    std::atomic<int> acks(0);
+    std::vector<std::thread> threads;
+    for (int w = 0; w < waiterCount; ++w) {
+        threads.emplace_back([&, w]() {
+            const int id = firstId + w;
+            for (;;) {
+                triggers.waitForTrigger(id);
+                if (done.load()) return;
+                long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+                totalLatencyNs.fetch_add(now - setTime.load());
+                triggers.clearTrigger(id);
+                acks.fetch_add(1);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    for (int r = 0; r < rounds; ++r) {
+        setTime.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+        triggers.setTrigger(firstId + r % waiterCount, true);
+        while (acks.load() != r + 1) std::this_thread::yield();
+    }
+    done.store(true);
+    for (int w = 0; w < waiterCount; ++w) triggers.setTrigger(firstId + w, true);
+    for (auto& t : threads) t.join();
+    std::cout << "set-to-wake latency, " << waiterCount << " waiters: "
+              << totalLatencyNs.load() / rounds / 1000.0 << " us average" << std::endl;
+    REQUIRE(acks.load() == rounds);
+}
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <unistd.h>
+
+TEST_CASE("TriggerHandler trigger fds multiplex in an epoll loop", "[TriggerHandler]") {
+    TriggerHandler triggers;
+    int captureFd = triggers.openTriggerFd({TRIG_CAPTURE});
+    int groupFd = triggers.openTriggerFd({TRIG_START, TRIG_STOP});
+    REQUIRE(captureFd >= 0);
+    REQUIRE(groupFd >= 0);
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    REQUIRE(ep >= 0);
+    for (int fd : {captureFd, groupFd}) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        REQUIRE(epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) == 0);
+    }
+    epoll_event ready[4];
+    REQUIRE(epoll_wait(ep, ready, 4, 0) == 0);
+
+    // A trigger set from another thread wakes the loop through its descriptor only
+    std::thread t([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        triggers.setTrigger(TRIG_CAPTURE, true);
+        triggers.clearTrigger(TRIG_CAPTURE);
+        triggers.setTrigger(TRIG_CAPTURE, true);
+    });
+    REQUIRE(epoll_wait(ep, ready, 4, 5000) == 1);
+    t.join();
+    REQUIRE(ready[0].data.fd == captureFd);
+    REQUIRE(TriggerHandler::consumeTriggerFd(captureFd) == 2); // two rising edges
+    REQUIRE(epoll_wait(ep, ready, 4, 0) == 0);
+
+    // Either trigger of a group signals the group descriptor; sparse ids work too
+    triggers.setTrigger(TRIG_STOP, true);
+    REQUIRE(epoll_wait(ep, ready, 4, 0) == 1);
+    REQUIRE(ready[0].data.fd == groupFd);
+    REQUIRE(TriggerHandler::consumeTriggerFd(groupFd) == 1);
+    REQUIRE(TriggerHandler::consumeTriggerFd(groupFd) == 0);
+
+    // A descriptor opened while a trigger is active is readable at once
+    int sparseFd = triggers.openTriggerFd({60000});
+    triggers.setTrigger(60000, true);
+    REQUIRE(TriggerHandler::consumeTriggerFd(sparseFd) == 1);
+    int lateFd = triggers.openTriggerFd({TRIG_STOP});
+    REQUIRE(TriggerHandler::consumeTriggerFd(lateFd) == 1);
+
+    REQUIRE(triggers.closeTriggerFd(sparseFd));
+    REQUIRE(triggers.closeTriggerFd(lateFd));
+    REQUIRE_FALSE(triggers.closeTriggerFd(lateFd));
+    close(ep);
+}
+#endif
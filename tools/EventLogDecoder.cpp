@@ -0,0 +1,25 @@
+// Offline decoder for binary event logs written by EventLog::exportBinary.
+// Usage: decode_events <file.evt>
+#include "EventLog.h"
+#include <cstdio>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <event-log-file>" << std::endl;
+        return 2;
+    }
+    std::vector<EventRecord> records;
+    if (!EventLog::importBinary(argv[1], records)) {
+        std::cerr << "Error: cannot read event log " << argv[1] << std::endl;
+        return 1;
+    }
+    // Timestamps are printed relative to the first record, in microseconds
+    std::uint64_t origin = records.empty() ? 0 : records.front().timestampNs;
+    char stamp[32];
+    for (const auto& rec : records) {
+        std::snprintf(stamp, sizeof(stamp), "%12.3f", (rec.timestampNs - origin) / 1000.0);
+        std::cout << stamp << " us  " << EventLog::format(rec) << "\n";
+    }
+    return 0;
+}